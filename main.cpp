@@ -9,10 +9,39 @@
 #include <iomanip>
 #include <fstream>
 #include <ctime>
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <new>
+#include <memory>
+#include <cstdlib>
+#include <array>
+#include <cmath>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(USE_PEXT) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 using namespace chrono;
 
+// Penghitung alokasi heap global, dipakai untuk membuktikan search tidak
+// melakukan alokasi per node (dibandingkan sebelum/sesudah search)
+atomic<uint64_t> heapAllocationCount(0);
+
+void* operator new(size_t size) {
+    heapAllocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* ptr = malloc(size ? size : 1)) return ptr;
+    throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
 // Enums untuk pieces dan colors
 enum PieceType { PAWN = 1, KNIGHT = 2, BISHOP = 3, ROOK = 4, QUEEN = 5, KING = 6 };
 enum Color { WHITE = 0, BLACK = 1 };
@@ -46,91 +75,1107 @@ struct Piece {
     }
 };
 
-// Struktur untuk move
+// Struktur untuk move, dipack ke 16 bit: from (6) | to (6) | flags (4)
+// Flags mengikuti encoding from-to-flags yang umum dipakai engine:
+// bit 2 = capture, bit 3 = promotion, dua bit bawah = detail (jenis promosi dsb.)
 struct Move {
-    int from, to;
-    PieceType promotion;
-    bool isCapture;
-    bool isCastling;
-    bool isEnPassant;
+    enum Flag {
+        QUIET = 0, DOUBLE_PUSH = 1, KING_CASTLE = 2, QUEEN_CASTLE = 3,
+        CAPTURE = 4, EN_PASSANT = 5,
+        PROMOTION = 8, PROMOTION_CAPTURE = 12
+    };
+    
+    uint16_t data;
+    
+    Move() : data(0) {}
+    Move(int from, int to, int flags = QUIET) : data(uint16_t(from | (to << 6) | (flags << 12))) {}
+    
+    // Promosi: flags = PROMOTION (+CAPTURE) + (type - KNIGHT)
+    static Move makePromotion(int from, int to, PieceType type, bool capture) {
+        return Move(from, to, (capture ? PROMOTION_CAPTURE : PROMOTION) | (type - KNIGHT));
+    }
+    
+    int from() const { return data & 0x3F; }
+    int to() const { return (data >> 6) & 0x3F; }
+    int flags() const { return data >> 12; }
+    
+    bool isCapture() const { return (flags() & CAPTURE) != 0; }
+    bool isPromotion() const { return (flags() & PROMOTION) != 0; }
+    bool isCastling() const { return flags() == KING_CASTLE || flags() == QUEEN_CASTLE; }
+    bool isEnPassant() const { return flags() == EN_PASSANT; }
+    PieceType promotion() const {
+        return isPromotion() ? PieceType(KNIGHT + (flags() & 3)) : PieceType(0);
+    }
     
-    Move() : from(-1), to(-1), promotion(PieceType(0)), 
-             isCapture(false), isCastling(false), isEnPassant(false) {}
-             
-    Move(int f, int t) : from(f), to(t), promotion(PieceType(0)), 
-                         isCapture(false), isCastling(false), isEnPassant(false) {}
+    bool isValid() const { return data != 0; }
     
-    bool isValid() const { return from >= 0 && to >= 0; }
+    bool operator==(const Move& other) const { return data == other.data; }
+    bool operator!=(const Move& other) const { return data != other.data; }
     
     string toString() const {
         if (!isValid()) return "invalid";
         
         string result = "";
-        result += char('a' + (from % 8));
-        result += char('1' + (from / 8));
-        result += char('a' + (to % 8));
-        result += char('1' + (to / 8));
+        result += char('a' + (from() % 8));
+        result += char('1' + (from() / 8));
+        result += char('a' + (to() % 8));
+        result += char('1' + (to() / 8));
         
-        if (promotion != 0) {
+        if (isPromotion()) {
             char promo[] = {'.', '.', 'n', 'b', 'r', 'q', '.'};
-            result += promo[promotion];
+            result += promo[promotion()];
         }
         
         return result;
     }
 };
 
+static_assert(sizeof(Move) == 2, "Move harus muat dalam 16 bit");
+
+// Move list berkapasitas tetap di stack, score disimpan berdampingan untuk ordering
+const int MAX_MOVES = 256;
+
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    int count;
+    
+    MoveList() : count(0) {}
+    
+    void add(const Move& move) {
+        moves[count] = move;
+        scores[count] = 0;
+        count++;
+    }
+    
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    Move& operator[](int i) { return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+    
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+    
+    // Selection sort bertahap: pindahkan move dengan score tertinggi ke index i
+    const Move& pickMove(int i) {
+        int best = i;
+        for (int j = i + 1; j < count; j++) {
+            if (scores[j] > scores[best]) best = j;
+        }
+        if (best != i) {
+            swap(moves[i], moves[best]);
+            swap(scores[i], scores[best]);
+        }
+        return moves[i];
+    }
+};
+
+// Bitboard: satu bit per square (a1 = bit 0, h8 = bit 63)
+typedef uint64_t Bitboard;
+
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard RANK_1_BB = 0xFFULL;
+const Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+constexpr Bitboard squareBB(int square) { return 1ULL << square; }
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER)
+    return int(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return int(index);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+// Tabel attack leaper dan ray, seluruhnya dihitung saat compile time
+struct Delta { int file, rank; };
+
+// Urutan arah ray: E, NE, N, NW, W, SW, S, SE (arah berlawanan = (d + 4) % 8)
+constexpr Delta RAY_DELTAS[8] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1},
+                                 {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+constexpr Delta KNIGHT_DELTAS[8] = {{1, 2}, {2, 1}, {2, -1}, {1, -2},
+                                    {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+const int NO_DIRECTION = -1;
+
+constexpr bool onBoard(int file, int rank) {
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+constexpr array<Bitboard, 64> makeLeaperAttacks(const Delta (&deltas)[8]) {
+    array<Bitboard, 64> table{};
+    for (int square = 0; square < 64; square++) {
+        for (const Delta& d : deltas) {
+            int file = square % 8 + d.file, rank = square / 8 + d.rank;
+            if (onBoard(file, rank)) table[square] |= squareBB(rank * 8 + file);
+        }
+    }
+    return table;
+}
+
+constexpr array<array<Bitboard, 64>, 2> makePawnAttacks() {
+    array<array<Bitboard, 64>, 2> table{};
+    for (int square = 0; square < 64; square++) {
+        int file = square % 8, rank = square / 8;
+        for (int df = -1; df <= 1; df += 2) {
+            if (onBoard(file + df, rank + 1)) table[WHITE][square] |= squareBB(square + 8 + df);
+            if (onBoard(file + df, rank - 1)) table[BLACK][square] |= squareBB(square - 8 + df);
+        }
+    }
+    return table;
+}
+
+// rays[d][sq]: semua square dari sq ke arah d pada board kosong (sq sendiri tidak termasuk)
+constexpr array<array<Bitboard, 64>, 8> makeRays() {
+    array<array<Bitboard, 64>, 8> table{};
+    for (int d = 0; d < 8; d++) {
+        for (int square = 0; square < 64; square++) {
+            int file = square % 8 + RAY_DELTAS[d].file, rank = square / 8 + RAY_DELTAS[d].rank;
+            while (onBoard(file, rank)) {
+                table[d][square] |= squareBB(rank * 8 + file);
+                file += RAY_DELTAS[d].file;
+                rank += RAY_DELTAS[d].rank;
+            }
+        }
+    }
+    return table;
+}
+
+constexpr array<array<Bitboard, 64>, 2> pawnAttacks = makePawnAttacks();
+constexpr array<Bitboard, 64> knightAttacks = makeLeaperAttacks(KNIGHT_DELTAS);
+constexpr array<Bitboard, 64> kingAttacks = makeLeaperAttacks(RAY_DELTAS);
+constexpr array<array<Bitboard, 64>, 8> rays = makeRays();
+
+// directionFrom[s1][s2]: arah ray dari s1 yang melewati s2, atau NO_DIRECTION
+constexpr array<array<int8_t, 64>, 64> makeDirections() {
+    array<array<int8_t, 64>, 64> table{};
+    for (int s1 = 0; s1 < 64; s1++) {
+        for (int s2 = 0; s2 < 64; s2++) {
+            table[s1][s2] = NO_DIRECTION;
+            for (int d = 0; d < 8; d++) {
+                if (rays[d][s1] & squareBB(s2)) table[s1][s2] = int8_t(d);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr array<array<int8_t, 64>, 64> directionFrom = makeDirections();
+
+// Square di antara dua square (eksklusif) dan garis penuh yang melewati keduanya
+constexpr array<array<Bitboard, 64>, 64> makeBetween() {
+    array<array<Bitboard, 64>, 64> table{};
+    for (int s1 = 0; s1 < 64; s1++) {
+        for (int s2 = 0; s2 < 64; s2++) {
+            int d = directionFrom[s1][s2];
+            if (d != NO_DIRECTION) table[s1][s2] = rays[d][s1] & rays[(d + 4) % 8][s2];
+        }
+    }
+    return table;
+}
+
+constexpr array<array<Bitboard, 64>, 64> makeLines() {
+    array<array<Bitboard, 64>, 64> table{};
+    for (int s1 = 0; s1 < 64; s1++) {
+        for (int s2 = 0; s2 < 64; s2++) {
+            int d = directionFrom[s1][s2];
+            if (d != NO_DIRECTION) table[s1][s2] = rays[d][s1] | rays[(d + 4) % 8][s1] | squareBB(s1);
+        }
+    }
+    return table;
+}
+
+constexpr array<array<Bitboard, 64>, 64> betweenBB = makeBetween();
+constexpr array<array<Bitboard, 64>, 64> lineBB = makeLines();
+
+// Attack slider pada board kosong, dipakai sebagai filter murah sebelum lookup magic
+constexpr Bitboard rookPseudoAttacks(int square) {
+    return rays[0][square] | rays[2][square] | rays[4][square] | rays[6][square];
+}
+
+constexpr Bitboard bishopPseudoAttacks(int square) {
+    return rays[1][square] | rays[3][square] | rays[5][square] | rays[7][square];
+}
+
+constexpr Bitboard fileBB(int file) { return FILE_A_BB << file; }
+constexpr Bitboard rankBB(int rank) { return RANK_1_BB << (8 * rank); }
+
+constexpr Bitboard adjacentFilesBB(int file) {
+    return (file > 0 ? fileBB(file - 1) : 0) | (file < 7 ? fileBB(file + 1) : 0);
+}
+
+// Square di depan pawn pada file sendiri dan file sebelahnya; pawn passed jika
+// tidak ada pawn lawan di mask ini
+constexpr array<array<Bitboard, 64>, 2> makePassedPawnMasks() {
+    array<array<Bitboard, 64>, 2> table{};
+    for (int sq = 0; sq < 64; sq++) {
+        int file = sq % 8, rank = sq / 8;
+        Bitboard files = fileBB(file) | adjacentFilesBB(file);
+        for (int r = rank + 1; r < 8; r++) table[0][sq] |= files & rankBB(r);
+        for (int r = rank - 1; r >= 0; r--) table[1][sq] |= files & rankBB(r);
+    }
+    return table;
+}
+
+constexpr array<array<Bitboard, 64>, 2> passedPawnMask = makePassedPawnMasks();
+
+// Magic bitboard entry untuk satu square slider
+struct Magic {
+    Bitboard mask;      // relevant occupancy (tanpa edge)
+    Bitboard magic;
+    Bitboard* attacks;  // pointer ke slice tabel attack milik square ini
+    int shift;
+
+    unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+Magic rookMagics[64];
+Magic bishopMagics[64];
+Bitboard rookTable[0x19000];   // 102400 entries
+Bitboard bishopTable[0x1480];  // 5248 entries
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    const Magic& m = rookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const Magic& m = bishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupied) {
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+// Ray walk lambat, hanya dipakai saat inisialisasi tabel
+Bitboard slidingAttack(int square, Bitboard occupied, const int deltas[4][2]) {
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        int file = square % 8 + deltas[d][0];
+        int rank = square / 8 + deltas[d][1];
+        while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+            int to = rank * 8 + file;
+            attacks |= squareBB(to);
+            if (occupied & squareBB(to)) break;
+            file += deltas[d][0];
+            rank += deltas[d][1];
+        }
+    }
+    return attacks;
+}
+
+// xorshift64* dengan seed tetap supaya magic yang ditemukan deterministik
+struct MagicRng {
+    uint64_t state;
+    explicit MagicRng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    uint64_t sparse() { return next() & next() & next(); }
+};
+
+void initMagics(Magic magics[64], Bitboard* table, const int deltas[4][2]) {
+    Bitboard occupancy[4096], reference[4096];
+    Bitboard* next = table;
+#if !defined(USE_PEXT)
+    // Entry tabel yang ditulis percobaan magic sebelumnya dianggap kosong
+    int epoch[4096] = {0};
+    int attempt = 0;
+    
+    // Seed per rank yang diketahui cepat menemukan magic (sama seperti Stockfish)
+    const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+#endif
+
+    for (int square = 0; square < 64; square++) {
+        // Edge squares tidak mempengaruhi attack, jadi dikeluarkan dari mask
+        Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~(RANK_1_BB << (8 * (square / 8)))) |
+                         ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << (square % 8)));
+
+        Magic& m = magics[square];
+        m.mask = slidingAttack(square, 0, deltas) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        // Enumerasi semua subset mask (Carry-Rippler)
+        int size = 0;
+        Bitboard subset = 0;
+        do {
+            occupancy[size] = subset;
+            reference[size] = slidingAttack(square, subset, deltas);
+            size++;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        next += size;
+
+#if defined(USE_PEXT)
+        for (int i = 0; i < size; i++) {
+            m.attacks[_pext_u64(occupancy[i], m.mask)] = reference[i];
+        }
+#else
+        // Cari magic yang memetakan setiap subset tanpa collision destruktif
+        MagicRng rng(seeds[square / 8]);
+        for (int i = 0; i < size; ) {
+            do {
+                m.magic = rng.sparse();
+            } while (popCount((m.mask * m.magic) >> 56) < 6);
+
+            attempt++;
+            for (i = 0; i < size; i++) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) {
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+// Hanya tabel magic yang dibangun saat runtime; tabel lain sudah constexpr
+void initAttackTables() {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+
+    const int rookDeltas[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    const int bishopDeltas[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    initMagics(rookMagics, rookTable, rookDeltas);
+    initMagics(bishopMagics, bishopTable, bishopDeltas);
+}
+
+// Castling rights sebagai bitmask KQkq
+enum CastlingRight { WHITE_OO = 1, WHITE_OOO = 2, BLACK_OO = 4, BLACK_OOO = 8, ALL_CASTLING = 15 };
+
+// Rights yang tersisa setelah piece bergerak dari/ke square tertentu (raja atau rook)
+constexpr array<int, 64> makeCastlingMasks() {
+    array<int, 64> masks{};
+    for (int square = 0; square < 64; square++) masks[square] = ALL_CASTLING;
+    masks[4] &= ~(WHITE_OO | WHITE_OOO);
+    masks[7] &= ~WHITE_OO;
+    masks[0] &= ~WHITE_OOO;
+    masks[60] &= ~(BLACK_OO | BLACK_OOO);
+    masks[63] &= ~BLACK_OO;
+    masks[56] &= ~BLACK_OOO;
+    return masks;
+}
+
+constexpr array<int, 64> castlingMasks = makeCastlingMasks();
+
+// Zobrist keys, dibangkitkan saat compile time dengan splitmix64
+struct ZobristKeys {
+    uint64_t pieces[2][7][64];
+    uint64_t castling[16];
+    uint64_t enPassantFile[8];
+    uint64_t side;
+};
+
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (int c = 0; c < 2; c++) {
+        for (int t = 1; t < 7; t++) {
+            for (int sq = 0; sq < 64; sq++) keys.pieces[c][t][sq] = splitMix64(state);
+        }
+    }
+    // Key castling per bit digabung supaya update cukup XOR lama dan baru
+    uint64_t rightKeys[4] = {splitMix64(state), splitMix64(state), splitMix64(state), splitMix64(state)};
+    for (int rights = 0; rights < 16; rights++) {
+        for (int bit = 0; bit < 4; bit++) {
+            if (rights & (1 << bit)) keys.castling[rights] ^= rightKeys[bit];
+        }
+    }
+    for (int file = 0; file < 8; file++) keys.enPassantFile[file] = splitMix64(state);
+    keys.side = splitMix64(state);
+    return keys;
+}
+
+constexpr ZobristKeys zobrist = makeZobristKeys();
+
+const string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Informasi yang dibutuhkan untuk membatalkan satu move
+struct UndoInfo {
+    Move move;
+    Piece captured;
+    int castlingRights;
+    int enPassantSquare;
+    int halfMoveClock;
+    uint64_t hashKey; // key posisi sebelum move, juga dipakai untuk deteksi repetisi
+};
+
+// Undo stack menampung riwayat game (dipangkas trimHistory sebelum mencapai MAX_GAME_PLY)
+// ditambah satu search penuh, dengan cadangan kecil untuk ponder move dan analisis gerakan
+const int MAX_GAME_PLY = 1024;
+const int MAX_PLY = 128;
+const int UNDO_STACK_SIZE = MAX_GAME_PLY + MAX_PLY + 8;
+
+// Jenis move yang dihasilkan generator: noisy = capture + promosi, quiet = sisanya
+enum GenType { GEN_ALL, GEN_NOISY, GEN_QUIET };
+
+// Nilai piece untuk static exchange evaluation dan MVV-LVA
+constexpr int seeValues[7] = {0, 100, 320, 330, 500, 900, 20000};
+
+// Nilai piece dan piece-square table (PeSTO) untuk midgame/endgame. Tabel ditulis dari
+// sudut pandang WHITE dengan rank 8 di baris pertama
+constexpr int mgPieceValue[7] = {0, 82, 337, 365, 477, 1025, 0};
+constexpr int egPieceValue[7] = {0, 94, 281, 297, 512, 936, 0};
+constexpr int phaseWeight[7] = {0, 0, 1, 1, 2, 4, 0};
+constexpr int MAX_PHASE = 24; // semua minor, rook dan queen masih di papan
+
+constexpr int mgPst[7][64] = {
+    {},
+    { // PAWN
+          0,   0,   0,   0,   0,   0,   0,   0,
+         98, 134,  61,  95,  68, 126,  34, -11,
+         -6,   7,  26,  31,  65,  56,  25, -20,
+        -14,  13,   6,  21,  23,  12,  17, -23,
+        -27,  -2,  -5,  12,  17,   6,  10, -25,
+        -26,  -4,  -4, -10,   3,   3,  33, -12,
+        -35,  -1, -20, -23, -15,  24,  38, -22,
+          0,   0,   0,   0,   0,   0,   0,   0,
+    },
+    { // KNIGHT
+        -167, -89, -34, -49,  61, -97, -15, -107,
+         -73, -41,  72,  36,  23,  62,   7,  -17,
+         -47,  60,  37,  65,  84, 129,  73,   44,
+          -9,  17,  19,  53,  37,  69,  18,   22,
+         -13,   4,  16,  13,  28,  19,  21,   -8,
+         -23,  -9,  12,  10,  19,  17,  25,  -16,
+         -29, -53, -12,  -3,  -1,  18, -14,  -19,
+        -105, -21, -58, -33, -17, -28, -19,  -23,
+    },
+    { // BISHOP
+        -29,   4, -82, -37, -25, -42,   7,  -8,
+        -26,  16, -18, -13,  30,  59,  18, -47,
+        -16,  37,  43,  40,  35,  50,  37,  -2,
+         -4,   5,  19,  50,  37,  37,   7,  -2,
+         -6,  13,  13,  26,  34,  12,  10,   4,
+          0,  15,  15,  15,  14,  27,  18,  10,
+          4,  15,  16,   0,   7,  21,  33,   1,
+        -33,  -3, -14, -21, -13, -12, -39, -21,
+    },
+    { // ROOK
+         32,  42,  32,  51,  63,   9,  31,  43,
+         27,  32,  58,  62,  80,  67,  26,  44,
+         -5,  19,  26,  36,  17,  45,  61,  16,
+        -24, -11,   7,  26,  24,  35,  -8, -20,
+        -36, -26, -12,  -1,   9,  -7,   6, -23,
+        -45, -25, -16, -17,   3,   0,  -5, -33,
+        -44, -16, -20,  -9,  -1,  11,  -6, -71,
+        -19, -13,   1,  17,  16,   7, -37, -26,
+    },
+    { // QUEEN
+        -28,   0,  29,  12,  59,  44,  43,  45,
+        -24, -39,  -5,   1, -16,  57,  28,  54,
+        -13, -17,   7,   8,  29,  56,  47,  57,
+        -27, -27, -16, -16,  -1,  17,  -2,   1,
+         -9, -26,  -9, -10,  -2,  -4,   3,  -3,
+        -14,   2, -11,  -2,  -5,   2,  14,   5,
+        -35,  -8,  11,   2,   8,  15,  -3,   1,
+         -1, -18,  -9,  10, -15, -25, -31, -50,
+    },
+    { // KING
+        -65,  23,  16, -15, -56, -34,   2,  13,
+         29,  -1, -20,  -7,  -8,  -4, -38, -29,
+         -9,  24,   2, -16, -20,   6,  22, -22,
+        -17, -20, -12, -27, -30, -25, -14, -36,
+        -49,  -1, -27, -39, -46, -44, -33, -51,
+        -14, -14, -22, -46, -44, -30, -15, -27,
+          1,   7,  -8, -64, -43, -16,   9,   8,
+        -15,  36,  12, -54,   8, -28,  24,  14,
+    },
+};
+
+constexpr int egPst[7][64] = {
+    {},
+    { // PAWN
+          0,   0,   0,   0,   0,   0,   0,   0,
+        178, 173, 158, 134, 147, 132, 165, 187,
+         94, 100,  85,  67,  56,  53,  82,  84,
+         32,  24,  13,   5,  -2,   4,  17,  17,
+         13,   9,  -3,  -7,  -7,  -8,   3,  -1,
+          4,   7,  -6,   1,   0,  -5,  -1,  -8,
+         13,   8,   8,  10,  13,   0,   2,  -7,
+          0,   0,   0,   0,   0,   0,   0,   0,
+    },
+    { // KNIGHT
+        -58, -38, -13, -28, -31, -27, -63, -99,
+        -25,  -8, -25,  -2,  -9, -25, -24, -52,
+        -24, -20,  10,   9,  -1,  -9, -19, -41,
+        -17,   3,  22,  22,  22,  11,   8, -18,
+        -18,  -6,  16,  25,  16,  17,   4, -18,
+        -23,  -3,  -1,  15,  10,  -3, -20, -22,
+        -42, -20, -10,  -5,  -2, -20, -23, -44,
+        -29, -51, -23, -15, -22, -18, -50, -64,
+    },
+    { // BISHOP
+        -14, -21, -11,  -8,  -7,  -9, -17, -24,
+         -8,  -4,   7, -12,  -3, -13,  -4, -14,
+          2,  -8,   0,  -1,  -2,   6,   0,   4,
+         -3,   9,  12,   9,  14,  10,   3,   2,
+         -6,   3,  13,  19,   7,  10,  -3,  -9,
+        -12,  -3,   8,  10,  13,   3,  -7, -15,
+        -14, -18,  -7,  -1,   4,  -9, -15, -27,
+        -23,  -9, -23,  -5,  -9, -16,  -5, -17,
+    },
+    { // ROOK
+         13,  10,  18,  15,  12,  12,   8,   5,
+         11,  13,  13,  11,  -3,   3,   8,   3,
+          7,   7,   7,   5,   4,  -3,  -5,  -3,
+          4,   3,  13,   1,   2,   1,  -1,   2,
+          3,   5,   8,   4,  -5,  -6,  -8, -11,
+         -4,   0,  -5,  -1,  -7, -12,  -8, -16,
+         -6,  -6,   0,   2,  -9,  -9, -11,  -3,
+         -9,   2,   3,  -1,  -5, -13,   4, -20,
+    },
+    { // QUEEN
+         -9,  22,  22,  27,  27,  19,  10,  20,
+        -17,  20,  32,  41,  58,  25,  30,   0,
+        -20,   6,   9,  49,  47,  35,  19,   9,
+          3,  22,  24,  45,  57,  40,  57,  36,
+        -18,  28,  19,  47,  31,  34,  39,  23,
+        -16, -27,  15,   6,   9,  17,  10,   5,
+        -22, -23, -30, -16, -16, -23, -36, -32,
+        -33, -28, -22, -43,  -5, -32, -20, -41,
+    },
+    { // KING
+        -74, -35, -18, -18, -11,  15,   4, -17,
+        -12,  17,  14,  17,  17,  38,  23,  11,
+         10,  17,  23,  15,  20,  45,  44,  13,
+         -8,  22,  24,  27,  26,  33,  26,   3,
+        -18,  -4,  21,  24,  27,  23,   9, -11,
+        -19,  -3,  11,  21,  23,  16,   7,  -9,
+        -27, -11,   4,  13,  14,   4,  -5, -17,
+        -53, -34, -21, -11, -28, -14, -24, -43,
+    },
+};
+
+// Nilai piece + PST per [color][type][square] dari perspektif WHITE (black bernilai negatif)
+struct PsqtTables {
+    int mg[2][7][64];
+    int eg[2][7][64];
+};
+
+constexpr PsqtTables makePsqtTables() {
+    PsqtTables tables{};
+    for (int t = PAWN; t <= KING; t++) {
+        for (int sq = 0; sq < 64; sq++) {
+            // Index tabel: a8 = 0, jadi square WHITE dicerminkan secara vertikal
+            tables.mg[WHITE][t][sq] = mgPieceValue[t] + mgPst[t][sq ^ 56];
+            tables.eg[WHITE][t][sq] = egPieceValue[t] + egPst[t][sq ^ 56];
+            tables.mg[BLACK][t][sq] = -(mgPieceValue[t] + mgPst[t][sq]);
+            tables.eg[BLACK][t][sq] = -(egPieceValue[t] + egPst[t][sq]);
+        }
+    }
+    return tables;
+}
+
+constexpr PsqtTables psqt = makePsqtTables();
+
+// ===== NNUE =====
+// Network HalfKA: fitur (square raja perspektif, piece relatif, square) dengan board dicerminkan
+// untuk BLACK, sehingga kedua perspektif memakai bobot yang sama. Feature transformer (int16)
+// di-update incremental oleh board; layer dense setelahnya int8 dengan aktivasi clipped ReLU
+// 0..127. Selain itu ada jalur PSQT linear (mg/eg) yang langsung ditambahkan ke output
+constexpr int NNUE_INPUTS = 64 * 12 * 64;
+constexpr int NNUE_HIDDEN = 128;  // lebar accumulator per perspektif
+constexpr int NNUE_L1 = 32;
+constexpr int NNUE_L2 = 32;
+constexpr int NNUE_WEIGHT_SHIFT = 6;   // bobot dense di-skala 64
+constexpr int NNUE_OUTPUT_SCALE = 16;  // output network / 16 = centipawn
+const char NNUE_MAGIC[8] = {'S', 'C', 'E', 'N', 'N', 'U', 'E', '1'};
+
+inline int nnueFeature(Color perspective, int kingSquare, const Piece& piece, int square) {
+    int flip = (perspective == WHITE) ? 0 : 56;
+    int relative = (piece.color == perspective) ? 0 : 6;
+    return ((kingSquare ^ flip) * 12 + relative + piece.type - 1) * 64 + (square ^ flip);
+}
+
+struct alignas(32) NnueAccumulator {
+    int16_t values[2][NNUE_HIDDEN]; // [perspektif][neuron]
+    int32_t psqt[2][2];             // [perspektif][mg/eg]
+};
+
+// Kernel SIMD: AVX2 jika dikompilasi dengan -mavx2 (atau -march=native), SSE sebagai
+// fallback x86-64, dan scalar untuk arsitektur lain
+#if defined(__AVX2__)
+inline int horizontalSum(__m256i sum) {
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum128);
+}
+#elif defined(__SSE2__)
+inline int horizontalSum(__m128i sum) {
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+inline void nnueAddColumn(int16_t* values, const int16_t* column) {
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i* target = reinterpret_cast<__m256i*>(values + i);
+        __m256i delta = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        _mm256_store_si256(target, _mm256_add_epi16(_mm256_load_si256(target), delta));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i* target = reinterpret_cast<__m128i*>(values + i);
+        __m128i delta = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        _mm_store_si128(target, _mm_add_epi16(_mm_load_si128(target), delta));
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) values[i] = int16_t(values[i] + column[i]);
+#endif
+}
+
+inline void nnueSubColumn(int16_t* values, const int16_t* column) {
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i* target = reinterpret_cast<__m256i*>(values + i);
+        __m256i delta = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        _mm256_store_si256(target, _mm256_sub_epi16(_mm256_load_si256(target), delta));
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i* target = reinterpret_cast<__m128i*>(values + i);
+        __m128i delta = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        _mm_store_si128(target, _mm_sub_epi16(_mm_load_si128(target), delta));
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) values[i] = int16_t(values[i] - column[i]);
+#endif
+}
+
+// Clipped ReLU accumulator int16 -> uint8 0..127
+inline void nnueClip(const int16_t* values, uint8_t* output) {
+#if defined(__AVX2__)
+    const __m256i limit = _mm256_set1_epi8(127);
+    for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i + 16));
+        // packus bekerja per lane 128-bit, permute mengembalikan urutan neuron
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_min_epu8(packed, limit));
+    }
+#elif defined(__SSE2__)
+    const __m128i limit = _mm_set1_epi8(127);
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_min_epu8(_mm_packus_epi16(a, b), limit));
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) output[i] = uint8_t(min(max(int(values[i]), 0), 127));
+#endif
+}
+
+// Layer dense: output[o] = bias[o] + dot(input, weights[o]); inSize kelipatan 32
+inline void nnueAffine(const uint8_t* input, int inSize, const int8_t* weights,
+                       const int32_t* bias, int32_t* output, int outSize) {
+    for (int o = 0; o < outSize; o++) {
+        const int8_t* row = weights + o * inSize;
+#if defined(__AVX2__)
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inSize; i += 32) {
+            __m256i product = _mm256_maddubs_epi16(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(product, ones));
+        }
+        output[o] = bias[o] + horizontalSum(sum);
+#elif defined(__SSE2__)
+        // Tanpa maddubs: input dan bobot dilebarkan ke int16 lalu madd
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < inSize; i += 16) {
+            __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            __m128i sign = _mm_cmpgt_epi8(zero, w);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(in, zero), _mm_unpacklo_epi8(w, sign)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(in, zero), _mm_unpackhi_epi8(w, sign)));
+        }
+        output[o] = bias[o] + horizontalSum(sum);
+#else
+        int32_t sum = bias[o];
+        for (int i = 0; i < inSize; i++) sum += int32_t(input[i]) * row[i];
+        output[o] = sum;
+#endif
+    }
+}
+
+inline void nnueActivate(const int32_t* input, uint8_t* output, int size) {
+    for (int i = 0; i < size; i++) {
+        output[i] = uint8_t(min(max(input[i] >> NNUE_WEIGHT_SHIFT, 0), 127));
+    }
+}
+
+class NnueNetwork {
+private:
+    vector<int16_t> ftWeights; // [fitur][neuron]
+    vector<int32_t> ftPsqt;    // [fitur][mg/eg]
+    alignas(32) int16_t ftBias[NNUE_HIDDEN];
+    alignas(32) int8_t l1Weights[NNUE_L1 * 2 * NNUE_HIDDEN]; // [output][input]
+    int32_t l1Bias[NNUE_L1];
+    alignas(32) int8_t l2Weights[NNUE_L2 * NNUE_L1];
+    int32_t l2Bias[NNUE_L2];
+    alignas(32) int8_t outWeights[NNUE_L2];
+    int32_t outBias;
+    string source;
+    
+    template<typename T>
+    static bool readArray(ifstream& file, T* data, size_t count) {
+        return bool(file.read(reinterpret_cast<char*>(data), streamsize(count * sizeof(T))));
+    }
+    
+    template<typename T>
+    static void writeArray(ofstream& file, const T* data, size_t count) {
+        file.write(reinterpret_cast<const char*>(data), streamsize(count * sizeof(T)));
+    }
+
+public:
+    NnueNetwork() { loadDefault(); }
+    
+    // Network bawaan: semua bobot dense nol dan jalur PSQT berisi material + PST PeSTO,
+    // sehingga outputnya sama dengan PSQT tapered evaluasi klasik
+    void loadDefault() {
+        ftWeights.assign(size_t(NNUE_INPUTS) * NNUE_HIDDEN, 0);
+        ftPsqt.assign(size_t(NNUE_INPUTS) * 2, 0);
+        fill(begin(ftBias), end(ftBias), int16_t(0));
+        fill(begin(l1Weights), end(l1Weights), int8_t(0));
+        fill(begin(l1Bias), end(l1Bias), 0);
+        fill(begin(l2Weights), end(l2Weights), int8_t(0));
+        fill(begin(l2Bias), end(l2Bias), 0);
+        fill(begin(outWeights), end(outWeights), int8_t(0));
+        outBias = 0;
+        
+        // Fitur sudah relatif terhadap perspektif: piece sendiri memakai tabel WHITE,
+        // piece lawan tabel BLACK (bernilai negatif), untuk semua posisi raja
+        for (int kingSquare = 0; kingSquare < 64; kingSquare++) {
+            for (int relative = 0; relative < 12; relative++) {
+                Color color = (relative < 6) ? WHITE : BLACK;
+                int type = relative % 6 + 1;
+                for (int square = 0; square < 64; square++) {
+                    size_t feature = size_t((kingSquare * 12 + relative) * 64 + square);
+                    ftPsqt[feature * 2] = psqt.mg[color][type][square];
+                    ftPsqt[feature * 2 + 1] = psqt.eg[color][type][square];
+                }
+            }
+        }
+        source = "bawaan (PSQT)";
+    }
+    
+    // Format file (little-endian): magic "SCENNUE1", int32 hidden/l1/l2 (harus sama dengan
+    // konstanta di atas), lalu ftBias, ftWeights, ftPsqt, l1Bias, l1Weights, l2Bias,
+    // l2Weights, outBias, outWeights. Network lama dipertahankan jika file tidak valid
+    bool load(const string& path) {
+        ifstream file(path, ios::binary);
+        char magic[8];
+        int32_t dims[3];
+        if (!file.read(magic, 8) || !equal(magic, magic + 8, NNUE_MAGIC) || !readArray(file, dims, 3) ||
+            dims[0] != NNUE_HIDDEN || dims[1] != NNUE_L1 || dims[2] != NNUE_L2) {
+            return false;
+        }
+        
+        NnueNetwork loaded(*this);
+        bool ok = readArray(file, loaded.ftBias, NNUE_HIDDEN) &&
+                  readArray(file, loaded.ftWeights.data(), loaded.ftWeights.size()) &&
+                  readArray(file, loaded.ftPsqt.data(), loaded.ftPsqt.size()) &&
+                  readArray(file, loaded.l1Bias, NNUE_L1) &&
+                  readArray(file, loaded.l1Weights, size_t(NNUE_L1) * 2 * NNUE_HIDDEN) &&
+                  readArray(file, loaded.l2Bias, NNUE_L2) &&
+                  readArray(file, loaded.l2Weights, size_t(NNUE_L2) * NNUE_L1) &&
+                  readArray(file, &loaded.outBias, 1) &&
+                  readArray(file, loaded.outWeights, NNUE_L2);
+        if (!ok) return false;
+        
+        *this = std::move(loaded);
+        source = path;
+        return true;
+    }
+    
+    bool save(const string& path) const {
+        ofstream file(path, ios::binary);
+        if (!file) return false;
+        int32_t dims[3] = {NNUE_HIDDEN, NNUE_L1, NNUE_L2};
+        file.write(NNUE_MAGIC, 8);
+        writeArray(file, dims, 3);
+        writeArray(file, ftBias, NNUE_HIDDEN);
+        writeArray(file, ftWeights.data(), ftWeights.size());
+        writeArray(file, ftPsqt.data(), ftPsqt.size());
+        writeArray(file, l1Bias, NNUE_L1);
+        writeArray(file, l1Weights, size_t(NNUE_L1) * 2 * NNUE_HIDDEN);
+        writeArray(file, l2Bias, NNUE_L2);
+        writeArray(file, l2Weights, size_t(NNUE_L2) * NNUE_L1);
+        writeArray(file, &outBias, 1);
+        writeArray(file, outWeights, NNUE_L2);
+        return bool(file);
+    }
+    
+    const string& getSource() const { return source; }
+    
+    void resetAccumulator(NnueAccumulator& acc, int perspective) const {
+        copy(begin(ftBias), end(ftBias), acc.values[perspective]);
+        acc.psqt[perspective][0] = acc.psqt[perspective][1] = 0;
+    }
+    
+    void addFeature(NnueAccumulator& acc, int perspective, int feature) const {
+        nnueAddColumn(acc.values[perspective], &ftWeights[size_t(feature) * NNUE_HIDDEN]);
+        acc.psqt[perspective][0] += ftPsqt[size_t(feature) * 2];
+        acc.psqt[perspective][1] += ftPsqt[size_t(feature) * 2 + 1];
+    }
+    
+    void removeFeature(NnueAccumulator& acc, int perspective, int feature) const {
+        nnueSubColumn(acc.values[perspective], &ftWeights[size_t(feature) * NNUE_HIDDEN]);
+        acc.psqt[perspective][0] -= ftPsqt[size_t(feature) * 2];
+        acc.psqt[perspective][1] -= ftPsqt[size_t(feature) * 2 + 1];
+    }
+    
+    // Score dari perspektif side to move; phase dipakai untuk taper jalur PSQT
+    int evaluate(const NnueAccumulator& acc, Color us, int phase) const {
+        alignas(32) uint8_t input[2 * NNUE_HIDDEN];
+        alignas(32) uint8_t hidden1[NNUE_L1];
+        alignas(32) uint8_t hidden2[NNUE_L2];
+        int32_t raw1[NNUE_L1], raw2[NNUE_L2], output;
+        
+        nnueClip(acc.values[us], input);
+        nnueClip(acc.values[1 - us], input + NNUE_HIDDEN);
+        nnueAffine(input, 2 * NNUE_HIDDEN, l1Weights, l1Bias, raw1, NNUE_L1);
+        nnueActivate(raw1, hidden1, NNUE_L1);
+        nnueAffine(hidden1, NNUE_L1, l2Weights, l2Bias, raw2, NNUE_L2);
+        nnueActivate(raw2, hidden2, NNUE_L2);
+        nnueAffine(hidden2, NNUE_L2, outWeights, &outBias, &output, 1);
+        
+        int mg = (acc.psqt[us][0] - acc.psqt[1 - us][0]) / 2;
+        int eg = (acc.psqt[us][1] - acc.psqt[1 - us][1]) / 2;
+        phase = min(phase, MAX_PHASE);
+        return output / NNUE_OUTPUT_SCALE + (mg * phase + eg * (MAX_PHASE - phase)) / MAX_PHASE;
+    }
+};
+
+// Bobot network (~12 MB) baru dialokasikan saat NNUE diaktifkan lewat UseNNUE, EvalFile,
+// menu konfigurasi atau --nnue, sehingga mode dengan evaluasi klasik tidak membayarnya.
+// Search hanya memakai nnueNet setelah useNnue aktif, jadi pointer di sana selalu terisi
+unique_ptr<NnueNetwork> nnueNet;
+
+NnueNetwork& nnueNetwork() {
+    if (!nnueNet) nnueNet.reset(new NnueNetwork());
+    return *nnueNet;
+}
+
 class ChessBoard {
 private:
-    Piece board[64];
+    Piece board[64];  // mailbox, secondary index untuk getPiece
+    Bitboard pieceBB[2][7]; // [color][type], index 0 tidak dipakai
+    Bitboard colorBB[2];
+    Bitboard occupiedBB;
     Color currentPlayer;
-    vector<string> moveHistory;
     int kingPositions[2]; // WHITE=0, BLACK=1
-    bool castlingRights[4]; // KQkq
+    int castlingRights; // bitmask KQkq
     int enPassantSquare;
     int halfMoveClock;
     int fullMoveNumber;
+    uint64_t hashKey; // Zobrist key, di-update incremental
+    uint64_t pawnKey;   // Zobrist dari pawn saja, untuk pawn hash
+    int psqtMg, psqtEg; // material + PST perspektif WHITE, di-update incremental
+    int gamePhase;      // 0 (hanya pawn/raja) .. MAX_PHASE, bisa lebih saat ada promosi
+    
+    // Accumulator NNUE. Jika incremental aktif, setPiece meng-update kolom fitur untuk
+    // perspektif yang masih valid; perspektif yang rajanya berpindah ditandai dirty dan
+    // dihitung ulang penuh (lazy) saat accumulator dibaca
+    mutable NnueAccumulator accumulator;
+    mutable bool accumulatorDirty[2];
+    bool nnueIncremental = false;
+    
+    // Undo stack berukuran tetap, juga menjadi riwayat gerakan permainan
+    UndoInfo undoStack[UNDO_STACK_SIZE];
+    int undoCount;
 
 public:
     ChessBoard() {
+        initAttackTables();
         setupInitialPosition();
     }
     
     void setupInitialPosition() {
-        // Clear board
+        setFromFEN(START_FEN);
+    }
+    
+    void clearBoard() {
         for (int i = 0; i < 64; i++) {
             board[i] = Piece();
         }
+        for (int c = 0; c < 2; c++) {
+            for (int t = 0; t < 7; t++) pieceBB[c][t] = 0;
+            colorBB[c] = 0;
+        }
+        occupiedBB = 0;
         
-        // Setup pieces
-        // White pieces
-        board[0] = Piece(ROOK, WHITE);   board[7] = Piece(ROOK, WHITE);
-        board[1] = Piece(KNIGHT, WHITE); board[6] = Piece(KNIGHT, WHITE);
-        board[2] = Piece(BISHOP, WHITE); board[5] = Piece(BISHOP, WHITE);
-        board[3] = Piece(QUEEN, WHITE);  board[4] = Piece(KING, WHITE);
+        currentPlayer = WHITE;
+        kingPositions[WHITE] = kingPositions[BLACK] = -1;
+        castlingRights = 0;
+        enPassantSquare = -1;
+        halfMoveClock = 0;
+        fullMoveNumber = 1;
+        hashKey = 0;
+        pawnKey = 0;
+        psqtMg = psqtEg = gamePhase = 0;
+        accumulatorDirty[WHITE] = accumulatorDirty[BLACK] = true;
+        undoCount = 0;
+    }
+    
+    // Parse posisi FEN; posisi awal dipakai kembali jika FEN tidak valid
+    bool setFromFEN(const string& fen) {
+        clearBoard();
+        
+        istringstream iss(fen);
+        string placement, side, castling, ep;
+        int halfMove = 0, fullMove = 1;
+        iss >> placement >> side >> castling >> ep;
+        if (!(iss >> halfMove)) halfMove = 0;
+        if (!(iss >> fullMove)) fullMove = 1;
+        
+        int rank = 7, file = 0;
+        for (char c : placement) {
+            if (c == '/') {
+                rank--;
+                file = 0;
+            } else if (c >= '1' && c <= '8') {
+                file += c - '0';
+            } else {
+                size_t index = string("PNBRQK").find(toupper(c));
+                if (index == string::npos || rank < 0 || file > 7) {
+                    if (fen != START_FEN) setFromFEN(START_FEN);
+                    return false;
+                }
+                Piece piece(PieceType(index + 1), isupper(c) ? WHITE : BLACK);
+                setPiece(rank * 8 + file, piece);
+                if (piece.type == KING) kingPositions[piece.color] = rank * 8 + file;
+                file++;
+            }
+        }
         
-        for (int i = 8; i < 16; i++) {
-            board[i] = Piece(PAWN, WHITE);
+        if (popCount(pieceBB[WHITE][KING]) != 1 || popCount(pieceBB[BLACK][KING]) != 1) {
+            if (fen != START_FEN) setFromFEN(START_FEN);
+            return false;
         }
         
-        // Black pieces
-        board[56] = Piece(ROOK, BLACK);   board[63] = Piece(ROOK, BLACK);
-        board[57] = Piece(KNIGHT, BLACK); board[62] = Piece(KNIGHT, BLACK);
-        board[58] = Piece(BISHOP, BLACK); board[61] = Piece(BISHOP, BLACK);
-        board[59] = Piece(QUEEN, BLACK);  board[60] = Piece(KING, BLACK);
+        currentPlayer = (side == "b") ? BLACK : WHITE;
         
-        for (int i = 48; i < 56; i++) {
-            board[i] = Piece(PAWN, BLACK);
+        for (char c : castling) {
+            if (c == 'K') castlingRights |= WHITE_OO;
+            if (c == 'Q') castlingRights |= WHITE_OOO;
+            if (c == 'k') castlingRights |= BLACK_OO;
+            if (c == 'q') castlingRights |= BLACK_OOO;
         }
         
-        currentPlayer = WHITE;
-        kingPositions[WHITE] = 4;
-        kingPositions[BLACK] = 60;
+        // Sama seperti makeMove: en passant hanya diset jika rank-nya cocok dengan side to move
+        // dan ada pawn yang bisa capture, supaya hash sama dengan posisi yang dicapai lewat gerakan
+        if (ep.length() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] == (currentPlayer == WHITE ? '6' : '3')) {
+            int epSquare = (ep[1] - '1') * 8 + (ep[0] - 'a');
+            Color pusher = Color(1 - currentPlayer);
+            if (pawnAttacks[pusher][epSquare] & pieceBB[currentPlayer][PAWN]) enPassantSquare = epSquare;
+        }
         
-        for (int i = 0; i < 4; i++) castlingRights[i] = true;
-        enPassantSquare = -1;
-        halfMoveClock = 0;
-        fullMoveNumber = 1;
+        halfMoveClock = halfMove;
+        fullMoveNumber = fullMove;
+        hashKey = computeHash();
+        return true;
+    }
+    
+    // Hitung key dari nol; di luar setFromFEN hanya untuk verifikasi
+    uint64_t computeHash() const {
+        uint64_t key = 0;
+        for (int square = 0; square < 64; square++) {
+            Piece piece = board[square];
+            if (!piece.isEmpty()) key ^= zobrist.pieces[piece.color][piece.type][square];
+        }
+        key ^= zobrist.castling[castlingRights];
+        if (enPassantSquare >= 0) key ^= zobrist.enPassantFile[enPassantSquare % 8];
+        if (currentPlayer == BLACK) key ^= zobrist.side;
+        return key;
+    }
+    
+    uint64_t getHashKey() const { return hashKey; }
+    uint64_t getPawnKey() const { return pawnKey; }
+    
+    string getFEN() const {
+        string fen;
+        for (int rank = 7; rank >= 0; rank--) {
+            int empty = 0;
+            for (int file = 0; file < 8; file++) {
+                Piece piece = board[rank * 8 + file];
+                if (piece.isEmpty()) {
+                    empty++;
+                    continue;
+                }
+                if (empty) fen += char('0' + empty);
+                empty = 0;
+                fen += piece.getSymbol();
+            }
+            if (empty) fen += char('0' + empty);
+            if (rank > 0) fen += '/';
+        }
+        
+        fen += (currentPlayer == WHITE) ? " w " : " b ";
+        if (castlingRights & WHITE_OO) fen += 'K';
+        if (castlingRights & WHITE_OOO) fen += 'Q';
+        if (castlingRights & BLACK_OO) fen += 'k';
+        if (castlingRights & BLACK_OOO) fen += 'q';
+        if (!castlingRights) fen += '-';
+        
+        if (enPassantSquare >= 0) {
+            fen += ' ';
+            fen += char('a' + enPassantSquare % 8);
+            fen += char('1' + enPassantSquare / 8);
+        } else {
+            fen += " -";
+        }
+        
+        fen += " " + to_string(halfMoveClock) + " " + to_string(fullMoveNumber);
+        return fen;
     }
     
     void printBoard() const {
@@ -156,319 +1201,1365 @@ public:
     }
     
     void setPiece(int square, const Piece& piece) {
-        if (square >= 0 && square < 64) {
-            board[square] = piece;
+        if (square < 0 || square >= 64) return;
+        
+        // Jaga mailbox dan bitboards tetap sinkron
+        Piece old = board[square];
+        if (!old.isEmpty()) {
+            pieceBB[old.color][old.type] ^= squareBB(square);
+            colorBB[old.color] ^= squareBB(square);
+            occupiedBB ^= squareBB(square);
+            hashKey ^= zobrist.pieces[old.color][old.type][square];
+            if (old.type == PAWN) pawnKey ^= zobrist.pieces[old.color][PAWN][square];
+            psqtMg -= psqt.mg[old.color][old.type][square];
+            psqtEg -= psqt.eg[old.color][old.type][square];
+            gamePhase -= phaseWeight[old.type];
+            updateAccumulator(old, square, false);
+        }
+        
+        board[square] = piece;
+        if (!piece.isEmpty()) {
+            pieceBB[piece.color][piece.type] |= squareBB(square);
+            colorBB[piece.color] |= squareBB(square);
+            occupiedBB |= squareBB(square);
+            hashKey ^= zobrist.pieces[piece.color][piece.type][square];
+            if (piece.type == PAWN) pawnKey ^= zobrist.pieces[piece.color][PAWN][square];
+            psqtMg += psqt.mg[piece.color][piece.type][square];
+            psqtEg += psqt.eg[piece.color][piece.type][square];
+            gamePhase += phaseWeight[piece.type];
+            updateAccumulator(piece, square, true);
+        }
+    }
+    
+    void updateAccumulator(const Piece& piece, int square, bool added) {
+        if (!nnueIncremental) {
+            accumulatorDirty[WHITE] = accumulatorDirty[BLACK] = true;
+            return;
+        }
+        if (piece.type == KING) accumulatorDirty[piece.color] = true;
+        
+        for (int p = WHITE; p <= BLACK; p++) {
+            if (accumulatorDirty[p]) continue;
+            int feature = nnueFeature(Color(p), kingPositions[p], piece, square);
+            if (added) nnueNet->addFeature(accumulator, p, feature);
+            else nnueNet->removeFeature(accumulator, p, feature);
         }
     }
     
+    // Board yang dipakai search dengan NNUE meng-update accumulator tiap move; tanpa itu
+    // accumulator dihitung ulang dari nol setiap kali dibaca
+    void setNnueIncremental(bool enabled) {
+        nnueIncremental = enabled;
+        accumulatorDirty[WHITE] = accumulatorDirty[BLACK] = true;
+    }
+    
+    const NnueAccumulator& getAccumulator() const {
+        for (int p = WHITE; p <= BLACK; p++) {
+            if (!accumulatorDirty[p] || !pieceBB[p][KING]) continue;
+            
+            int kingSquare = lsb(pieceBB[p][KING]);
+            nnueNet->resetAccumulator(accumulator, p);
+            Bitboard pieces = occupiedBB;
+            while (pieces) {
+                int square = popLsb(pieces);
+                nnueNet->addFeature(accumulator, p, nnueFeature(Color(p), kingSquare, board[square], square));
+            }
+            accumulatorDirty[p] = false;
+        }
+        return accumulator;
+    }
+    
+    Bitboard getPieces(Color color, PieceType type) const { return pieceBB[color][type]; }
+    Bitboard getPieces(Color color) const { return colorBB[color]; }
+    Bitboard getOccupied() const { return occupiedBB; }
+    
     Color getCurrentPlayer() const { return currentPlayer; }
     
+    // Blend midgame/endgame sesuai sisa material
+    int taper(int mg, int eg) const {
+        int phase = min(gamePhase, MAX_PHASE);
+        return (mg * phase + eg * (MAX_PHASE - phase)) / MAX_PHASE;
+    }
+    
+    int taperedPsqt() const { return taper(psqtMg, psqtEg); }
+    int getGamePhase() const { return gamePhase; }
+    
+    // Semua piece (kedua warna) yang menyerang square dengan occupancy tertentu
+    Bitboard attackersTo(int square, Bitboard occupied) const {
+        Bitboard rookLike = pieceBB[WHITE][ROOK] | pieceBB[BLACK][ROOK] |
+                            pieceBB[WHITE][QUEEN] | pieceBB[BLACK][QUEEN];
+        Bitboard bishopLike = pieceBB[WHITE][BISHOP] | pieceBB[BLACK][BISHOP] |
+                              pieceBB[WHITE][QUEEN] | pieceBB[BLACK][QUEEN];
+        
+        return (pawnAttacks[BLACK][square] & pieceBB[WHITE][PAWN]) |
+               (pawnAttacks[WHITE][square] & pieceBB[BLACK][PAWN]) |
+               (knightAttacks[square] & (pieceBB[WHITE][KNIGHT] | pieceBB[BLACK][KNIGHT])) |
+               (kingAttacks[square] & (pieceBB[WHITE][KING] | pieceBB[BLACK][KING])) |
+               (rookAttacks(square, occupied) & rookLike) |
+               (bishopAttacks(square, occupied) & bishopLike);
+    }
+    
+    // Beberapa lookup tabel; slider hanya di-lookup jika ada yang sejajar di board kosong
+    bool isSquareAttacked(int square, Color attackingColor, Bitboard occupied) const {
+        const Bitboard* pieces = pieceBB[attackingColor];
+        if (pawnAttacks[1 - attackingColor][square] & pieces[PAWN]) return true;
+        if (knightAttacks[square] & pieces[KNIGHT]) return true;
+        if (kingAttacks[square] & pieces[KING]) return true;
+        
+        Bitboard rookLike = pieces[ROOK] | pieces[QUEEN];
+        if ((rookPseudoAttacks(square) & rookLike) && (rookAttacks(square, occupied) & rookLike)) return true;
+        
+        Bitboard bishopLike = pieces[BISHOP] | pieces[QUEEN];
+        return (bishopPseudoAttacks(square) & bishopLike) && (bishopAttacks(square, occupied) & bishopLike);
+    }
+    
     bool isSquareAttacked(int square, Color attackingColor) const {
-        // Simplified attack detection
-        for (int i = 0; i < 64; i++) {
-            Piece piece = board[i];
-            if (piece.isEmpty() || piece.color != attackingColor) continue;
+        return isSquareAttacked(square, attackingColor, occupiedBB);
+    }
+    
+    PieceType capturedType(const Move& move) const {
+        if (move.isEnPassant()) return PAWN;
+        return board[move.to()].type;
+    }
+    
+    // Static exchange evaluation (swap algorithm): hasil material dari rangkaian
+    // capture di square tujuan, masing-masing pihak memakai attacker termurah.
+    // X-ray slider di belakang attacker ikut dihitung; pin diabaikan.
+    int see(const Move& move) const {
+        if (move.isCastling()) return 0;
+        
+        int from = move.from(), to = move.to();
+        int gain[32];
+        int d = 0;
+        
+        Bitboard occupied = occupiedBB ^ squareBB(from);
+        if (move.isEnPassant()) occupied ^= squareBB(to + (currentPlayer == WHITE ? -8 : 8));
+        
+        PieceType attacker = board[from].type;
+        gain[0] = seeValues[capturedType(move)];
+        if (move.isPromotion()) {
+            gain[0] += seeValues[move.promotion()] - seeValues[PAWN];
+            attacker = move.promotion();
+        }
+        
+        Bitboard rookLike = pieceBB[WHITE][ROOK] | pieceBB[BLACK][ROOK] |
+                            pieceBB[WHITE][QUEEN] | pieceBB[BLACK][QUEEN];
+        Bitboard bishopLike = pieceBB[WHITE][BISHOP] | pieceBB[BLACK][BISHOP] |
+                              pieceBB[WHITE][QUEEN] | pieceBB[BLACK][QUEEN];
+        Bitboard attackers = attackersTo(to, occupied) & occupied;
+        Color side = Color(1 - currentPlayer);
+        
+        while (true) {
+            d++;
+            gain[d] = seeValues[attacker] - gain[d - 1];
+            if (max(-gain[d - 1], gain[d]) < 0) break;  // tidak ada pihak yang untung lagi
             
-            if (canPieceAttackSquare(i, square, piece)) {
-                return true;
+            Bitboard ours = attackers & colorBB[side];
+            if (!ours || d >= 31) break;
+            
+            // Attacker termurah milik pihak yang sedang giliran
+            int type = PAWN;
+            while (!(ours & pieceBB[side][type])) type++;
+            Bitboard fromSet = ours & pieceBB[side][type];
+            occupied ^= fromSet & (~fromSet + 1);
+            attacker = PieceType(type);
+            
+            // Buka x-ray di belakang piece yang baru bergerak
+            if (type == PAWN || type == BISHOP || type == QUEEN) {
+                attackers |= bishopAttacks(to, occupied) & bishopLike;
+            }
+            if (type == ROOK || type == QUEEN) {
+                attackers |= rookAttacks(to, occupied) & rookLike;
             }
+            attackers &= occupied;
+            side = Color(1 - side);
         }
-        return false;
+        
+        while (--d) gain[d - 1] = -max(-gain[d - 1], gain[d]);
+        return gain[0];
+    }
+    
+    Bitboard pieceAttacks(int from, const Piece& piece, Bitboard occupied) const {
+        switch (piece.type) {
+            case PAWN:   return pawnAttacks[piece.color][from];
+            case KNIGHT: return knightAttacks[from];
+            case BISHOP: return bishopAttacks(from, occupied);
+            case ROOK:   return rookAttacks(from, occupied);
+            case QUEEN:  return queenAttacks(from, occupied);
+            case KING:   return kingAttacks[from];
+        }
+        return 0;
     }
     
     bool canPieceAttackSquare(int from, int to, const Piece& piece) const {
-        int dx = (to % 8) - (from % 8);
-        int dy = (to / 8) - (from / 8);
+        return (pieceAttacks(from, piece, occupiedBB) & squareBB(to)) != 0;
+    }
+    
+    bool isInCheck(Color color) const {
+        return isSquareAttacked(kingPositions[color], Color(1 - color));
+    }
+    
+    // Ada piece selain pawn dan raja; tanpa itu zugzwang terlalu sering untuk null move
+    bool hasNonPawnMaterial(Color color) const {
+        return (colorBB[color] & ~pieceBB[color][PAWN] & ~pieceBB[color][KING]) != 0;
+    }
+    
+    // Piece milik color yang di-pin ke rajanya sendiri
+    Bitboard pinnedPieces(Color color) const {
+        int kingSquare = kingPositions[color];
+        Color them = Color(1 - color);
+        Bitboard snipers = (rookPseudoAttacks(kingSquare) & (pieceBB[them][ROOK] | pieceBB[them][QUEEN])) |
+                           (bishopPseudoAttacks(kingSquare) & (pieceBB[them][BISHOP] | pieceBB[them][QUEEN]));
         
-        switch (piece.type) {
-            case PAWN: {
-                int direction = (piece.color == WHITE) ? 1 : -1;
-                return abs(dx) == 1 && dy == direction;
+        Bitboard pinned = 0;
+        while (snipers) {
+            int sniper = popLsb(snipers);
+            Bitboard blockers = betweenBB[kingSquare][sniper] & occupiedBB;
+            if (popCount(blockers) == 1) {
+                pinned |= blockers & colorBB[color];
+            }
+        }
+        return pinned;
+    }
+    
+    // Target squares yang sesuai dengan jenis generasi
+    Bitboard targetFilter(GenType type, Color us) const {
+        if (type == GEN_NOISY) return colorBB[1 - us];
+        if (type == GEN_QUIET) return ~occupiedBB;
+        return ~colorBB[us];
+    }
+    
+    // Checkers, pinned pieces dan evasion mask dihitung sekali per node,
+    // lalu setiap generator hanya menghasilkan move yang legal.
+    // fromMask membatasi square asal (dipakai untuk validasi satu move)
+    void generateLegalMoves(MoveList& moves, GenType type = GEN_ALL, Bitboard fromMask = ~0ULL) const {
+        Color us = currentPlayer;
+        int kingSquare = kingPositions[us];
+        Bitboard checkers = attackersTo(kingSquare, occupiedBB) & colorBB[1 - us];
+        
+        if (fromMask & squareBB(kingSquare)) {
+            generateKingMoves(kingSquare, board[kingSquare], targetFilter(type, us), moves);
+        }
+        
+        // Double check: hanya raja yang boleh bergerak
+        if (popCount(checkers) > 1) return;
+        
+        // Evasion: capture checker atau block di antara checker dan raja
+        Bitboard checkMask = ~0ULL;
+        if (checkers) {
+            int checker = lsb(checkers);
+            checkMask = betweenBB[kingSquare][checker] | checkers;
+        }
+        
+        Bitboard pinned = pinnedPieces(us);
+        Bitboard pieces = colorBB[us] & ~pieceBB[us][KING] & fromMask;
+        while (pieces) {
+            int from = popLsb(pieces);
+            Bitboard allowed = checkMask;
+            if (pinned & squareBB(from)) {
+                allowed &= lineBB[kingSquare][from];
+            }
+            generatePieceMoves(from, board[from], allowed, type, moves);
+        }
+        
+        if (type != GEN_QUIET) generateEnPassant(kingSquare, fromMask, moves);
+        if (type != GEN_NOISY && !checkers && (fromMask & squareBB(kingSquare))) generateCastling(moves);
+    }
+    
+    // Validasi move dari sumber luar (hash move, killer) dengan generator legal
+    // yang dibatasi ke square asal move tersebut
+    bool isMoveLegal(const Move& move) const {
+        if (!move.isValid()) return false;
+        Piece piece = board[move.from()];
+        if (piece.isEmpty() || piece.color != currentPlayer) return false;
+        
+        MoveList moves;
+        generateLegalMoves(moves, GEN_ALL, squareBB(move.from()));
+        for (const Move& m : moves) {
+            if (m == move) return true;
+        }
+        return false;
+    }
+    
+    // En passant dicek dengan occupancy setelah capture, karena pawn yang
+    // dimakan bisa membuka garis ke raja (termasuk pin horizontal)
+    void generateEnPassant(int kingSquare, Bitboard fromMask, MoveList& moves) const {
+        if (enPassantSquare < 0) return;
+        
+        Color us = currentPlayer, them = Color(1 - us);
+        int capturedSquare = enPassantSquare + (us == WHITE ? -8 : 8);
+        Bitboard candidates = pawnAttacks[them][enPassantSquare] & pieceBB[us][PAWN] & fromMask;
+        
+        while (candidates) {
+            int from = popLsb(candidates);
+            Bitboard occupied = (occupiedBB ^ squareBB(from) ^ squareBB(capturedSquare)) | squareBB(enPassantSquare);
+            Bitboard attackers = attackersTo(kingSquare, occupied) & colorBB[them] & ~squareBB(capturedSquare);
+            if (!attackers) {
+                moves.add(Move(from, enPassantSquare, Move::EN_PASSANT));
             }
+        }
+    }
+    
+    // Castling standar: raja tidak sedang skak, square antara raja dan rook
+    // kosong, dan square yang dilewati raja tidak diserang
+    void generateCastling(MoveList& moves) const {
+        Color us = currentPlayer, them = Color(1 - us);
+        int kingFrom = (us == WHITE) ? 4 : 60;
+        int kingSide = (us == WHITE) ? WHITE_OO : BLACK_OO;
+        int queenSide = (us == WHITE) ? WHITE_OOO : BLACK_OOO;
+        
+        if ((castlingRights & kingSide) &&
+            !(occupiedBB & (squareBB(kingFrom + 1) | squareBB(kingFrom + 2))) &&
+            !isSquareAttacked(kingFrom + 1, them) && !isSquareAttacked(kingFrom + 2, them)) {
+            moves.add(Move(kingFrom, kingFrom + 2, Move::KING_CASTLE));
+        }
+        
+        if ((castlingRights & queenSide) &&
+            !(occupiedBB & (squareBB(kingFrom - 1) | squareBB(kingFrom - 2) | squareBB(kingFrom - 3))) &&
+            !isSquareAttacked(kingFrom - 1, them) && !isSquareAttacked(kingFrom - 2, them)) {
+            moves.add(Move(kingFrom, kingFrom - 2, Move::QUEEN_CASTLE));
+        }
+    }
+    
+    // allowed: target squares yang diizinkan oleh check mask dan pin ray
+    void generatePieceMoves(int from, const Piece& piece, Bitboard allowed, GenType type, MoveList& moves) const {
+        Bitboard targets = 0;
+        
+        switch (piece.type) {
+            case PAWN:
+                generatePawnMoves(from, piece, allowed, type, moves);
+                return;
             case KNIGHT:
-                return (abs(dx) == 2 && abs(dy) == 1) || (abs(dx) == 1 && abs(dy) == 2);
+                targets = knightAttacks[from];
+                break;
             case BISHOP:
-                return abs(dx) == abs(dy) && isPathClear(from, to);
+                targets = bishopAttacks(from, occupiedBB);
+                break;
             case ROOK:
-                return (dx == 0 || dy == 0) && isPathClear(from, to);
+                targets = rookAttacks(from, occupiedBB);
+                break;
             case QUEEN:
-                return (dx == 0 || dy == 0 || abs(dx) == abs(dy)) && isPathClear(from, to);
+                targets = queenAttacks(from, occupiedBB);
+                break;
             case KING:
-                return abs(dx) <= 1 && abs(dy) <= 1;
+                generateKingMoves(from, piece, targetFilter(type, piece.color), moves);
+                return;
+        }
+        
+        addMoves(from, targets & targetFilter(type, piece.color) & allowed, piece.color, moves);
+    }
+    
+    // Ubah target bitboard jadi list move; capture ditandai dari occupancy lawan
+    void addMoves(int from, Bitboard targets, Color color, MoveList& moves) const {
+        Bitboard enemies = colorBB[1 - color];
+        while (targets) {
+            int to = popLsb(targets);
+            moves.add(Move(from, to, (enemies & squareBB(to)) ? Move::CAPTURE : Move::QUIET));
         }
-        return false;
     }
     
-    bool isPathClear(int from, int to) const {
-        int dx = (to % 8) - (from % 8);
-        int dy = (to / 8) - (from / 8);
+    // Push promosi termasuk noisy; push biasa dan double push termasuk quiet
+    void generatePawnMoves(int from, const Piece& piece, Bitboard allowed, GenType type, MoveList& moves) const {
+        int direction = (piece.color == WHITE) ? 8 : -8;
+        Bitboard startRank = (piece.color == WHITE) ? (RANK_1_BB << 8) : (RANK_1_BB << 48);
+        Bitboard enemies = colorBB[1 - piece.color];
         
-        int stepX = (dx == 0) ? 0 : (dx > 0 ? 1 : -1);
-        int stepY = (dy == 0) ? 0 : (dy > 0 ? 1 : -1);
+        // Forward move
+        int to = from + direction;
+        if (!(occupiedBB & squareBB(to))) {
+            bool promotion = (squareBB(to) & (RANK_1_BB | RANK_8_BB)) != 0;
+            if ((allowed & squareBB(to)) && (type == GEN_ALL || (type == GEN_NOISY) == promotion)) {
+                addPawnMove(from, to, false, moves);
+            }
+            
+            // Double pawn move
+            int doubleTo = to + direction;
+            if (type != GEN_NOISY && (startRank & squareBB(from)) &&
+                !(occupiedBB & squareBB(doubleTo)) && (allowed & squareBB(doubleTo))) {
+                moves.add(Move(from, doubleTo, Move::DOUBLE_PUSH));
+            }
+        }
         
-        int current = from + stepX + stepY * 8;
+        // Captures (en passant ditangani terpisah di generateEnPassant)
+        if (type == GEN_QUIET) return;
+        Bitboard captures = pawnAttacks[piece.color][from] & enemies & allowed;
+        while (captures) {
+            addPawnMove(from, popLsb(captures), true, moves);
+        }
+    }
+    
+    // Pawn yang mencapai rank terakhir menghasilkan empat pilihan promosi
+    void addPawnMove(int from, int to, bool capture, MoveList& moves) const {
+        if (squareBB(to) & (RANK_1_BB | RANK_8_BB)) {
+            for (int type = QUEEN; type >= KNIGHT; type--) {
+                moves.add(Move::makePromotion(from, to, PieceType(type), capture));
+            }
+        } else {
+            moves.add(Move(from, to, capture ? Move::CAPTURE : Move::QUIET));
+        }
+    }
+    
+    // Raja tidak boleh masuk square yang diserang; raja diangkat dari occupancy
+    // supaya square di belakangnya (pada ray slider) tetap terhitung diserang
+    void generateKingMoves(int from, const Piece& piece, Bitboard filter, MoveList& moves) const {
+        Bitboard occupied = occupiedBB ^ squareBB(from);
+        Bitboard enemies = colorBB[1 - piece.color];
+        Bitboard targets = kingAttacks[from] & filter;
         
-        while (current != to) {
-            if (!board[current].isEmpty()) return false;
-            current += stepX + stepY * 8;
+        while (targets) {
+            int to = popLsb(targets);
+            if (isSquareAttacked(to, Color(1 - piece.color), occupied)) continue;
+            
+            moves.add(Move(from, to, (enemies & squareBB(to)) ? Move::CAPTURE : Move::QUIET));
         }
+    }
+    
+    bool makeMove(const Move& move) {
+        assert(undoCount < UNDO_STACK_SIZE);
+        if (!move.isValid() || undoCount >= UNDO_STACK_SIZE) return false;
+        
+        int from = move.from(), to = move.to();
+        Color us = currentPlayer, them = Color(1 - us);
+        Piece movingPiece = board[from];
+        int capturedSquare = move.isEnPassant() ? to + (us == WHITE ? -8 : 8) : to;
+        Piece capturedPiece = board[capturedSquare];
+        
+        // Simpan state untuk unmakeMove
+        UndoInfo& undo = undoStack[undoCount++];
+        undo.move = move;
+        undo.captured = capturedPiece;
+        undo.castlingRights = castlingRights;
+        undo.enPassantSquare = enPassantSquare;
+        undo.halfMoveClock = halfMoveClock;
+        undo.hashKey = hashKey;
+        
+        // Update king position
+        if (movingPiece.type == KING) {
+            kingPositions[us] = to;
+        }
+        
+        // Make the move
+        if (!capturedPiece.isEmpty()) setPiece(capturedSquare, Piece());
+        setPiece(from, Piece());
+        setPiece(to, move.isPromotion() ? Piece(move.promotion(), us) : movingPiece);
+        
+        // Castling: pindahkan rook juga
+        if (move.isCastling()) {
+            int rookFrom = (move.flags() == Move::KING_CASTLE) ? to + 1 : to - 2;
+            int rookTo = (move.flags() == Move::KING_CASTLE) ? to - 1 : to + 1;
+            setPiece(rookTo, board[rookFrom]);
+            setPiece(rookFrom, Piece());
+        }
+        
+        hashKey ^= zobrist.castling[castlingRights];
+        castlingRights &= castlingMasks[from] & castlingMasks[to];
+        hashKey ^= zobrist.castling[castlingRights];
+        
+        // En passant square hanya diset jika memang ada pawn lawan yang bisa capture,
+        // supaya posisi yang sama selalu punya state (dan hash) yang sama
+        if (enPassantSquare >= 0) hashKey ^= zobrist.enPassantFile[enPassantSquare % 8];
+        enPassantSquare = -1;
+        if (move.flags() == Move::DOUBLE_PUSH) {
+            int epSquare = (from + to) / 2;
+            if (pawnAttacks[us][epSquare] & pieceBB[them][PAWN]) {
+                enPassantSquare = epSquare;
+                hashKey ^= zobrist.enPassantFile[epSquare % 8];
+            }
+        }
+        
+        // Update clocks
+        if (movingPiece.type == PAWN || !capturedPiece.isEmpty()) halfMoveClock = 0;
+        else halfMoveClock++;
+        if (us == BLACK) fullMoveNumber++;
+        
+        // Switch players
+        currentPlayer = them;
+        hashKey ^= zobrist.side;
         
         return true;
     }
     
-    bool isInCheck(Color color) const {
-        return isSquareAttacked(kingPositions[color], Color(1 - color));
+    void unmakeMove() {
+        if (undoCount == 0) return;
+        
+        const UndoInfo& undo = undoStack[--undoCount];
+        const Move& move = undo.move;
+        int from = move.from(), to = move.to();
+        
+        // Switch players back
+        currentPlayer = Color(1 - currentPlayer);
+        Color us = currentPlayer;
+        if (us == BLACK) fullMoveNumber--;
+        
+        if (move.isCastling()) {
+            int rookFrom = (move.flags() == Move::KING_CASTLE) ? to + 1 : to - 2;
+            int rookTo = (move.flags() == Move::KING_CASTLE) ? to - 1 : to + 1;
+            setPiece(rookFrom, board[rookTo]);
+            setPiece(rookTo, Piece());
+        }
+        
+        Piece movingPiece = move.isPromotion() ? Piece(PAWN, us) : board[to];
+        if (movingPiece.type == KING) {
+            kingPositions[us] = from;
+        }
+        
+        setPiece(to, Piece());
+        setPiece(from, movingPiece);
+        if (!undo.captured.isEmpty()) {
+            int capturedSquare = move.isEnPassant() ? to + (us == WHITE ? -8 : 8) : to;
+            setPiece(capturedSquare, undo.captured);
+        }
+        
+        castlingRights = undo.castlingRights;
+        enPassantSquare = undo.enPassantSquare;
+        halfMoveClock = undo.halfMoveClock;
+        hashKey = undo.hashKey;
     }
     
-    vector<Move> generateLegalMoves() const {
-        vector<Move> moves;
+    // Null move: side to move melewatkan giliran (untuk null-move pruning, tidak saat skak)
+    bool makeNullMove() {
+        assert(undoCount < UNDO_STACK_SIZE);
+        if (undoCount >= UNDO_STACK_SIZE) return false;
         
-        for (int from = 0; from < 64; from++) {
-            Piece piece = board[from];
-            if (piece.isEmpty() || piece.color != currentPlayer) continue;
-            
-            vector<Move> pieceMoves = generatePieceMoves(from, piece);
-            for (const Move& move : pieceMoves) {
-                if (isMoveLegal(move)) {
-                    moves.push_back(move);
-                }
+        UndoInfo& undo = undoStack[undoCount++];
+        undo.move = Move();
+        undo.captured = Piece();
+        undo.castlingRights = castlingRights;
+        undo.enPassantSquare = enPassantSquare;
+        undo.halfMoveClock = halfMoveClock;
+        undo.hashKey = hashKey;
+        
+        if (enPassantSquare >= 0) hashKey ^= zobrist.enPassantFile[enPassantSquare % 8];
+        enPassantSquare = -1;
+        
+        // Repetisi tidak boleh dicari melewati null move
+        halfMoveClock = 0;
+        
+        currentPlayer = Color(1 - currentPlayer);
+        hashKey ^= zobrist.side;
+        return true;
+    }
+    
+    void unmakeNullMove() {
+        if (undoCount == 0) return;
+        
+        const UndoInfo& undo = undoStack[--undoCount];
+        currentPlayer = Color(1 - currentPlayer);
+        enPassantSquare = undo.enPassantSquare;
+        halfMoveClock = undo.halfMoveClock;
+        hashKey = undo.hashKey;
+    }
+    
+    // Posisi sekarang sudah pernah muncul sebanyak 'count' kali sejak capture/pawn move
+    // terakhir (hanya posisi dengan side to move yang sama yang dicek)
+    bool isRepetition(int count = 1) const {
+        int found = 0;
+        int limit = max(0, undoCount - halfMoveClock);
+        for (int i = undoCount - 2; i >= limit; i -= 2) {
+            if (undoStack[i].hashKey == hashKey && ++found >= count) return true;
+        }
+        return false;
+    }
+    
+    // Draw karena repetisi atau aturan 50 langkah
+    bool isDrawByRule(int repetitions = 1) const {
+        return halfMoveClock >= 100 || isRepetition(repetitions);
+    }
+    
+    // Hitung leaf nodes sampai depth tertentu (bulk counting di depth 1)
+    uint64_t perft(int depth) {
+        MoveList moves;
+        generateLegalMoves(moves);
+        if (depth <= 1) return depth == 1 ? moves.size() : 1;
+        
+        uint64_t nodes = 0;
+        for (const Move& move : moves) {
+            makeMove(move);
+            nodes += perft(depth - 1);
+            unmakeMove();
+        }
+        return nodes;
+    }
+    
+    // Dipanggil setelah move di level game (bukan di search). Record yang lebih tua dari
+    // halfMoveClock tidak lagi dipakai deteksi repetisi, jadi dibuang begitu riwayat mencapai
+    // MAX_GAME_PLY supaya search selalu punya MAX_PLY slot; move yang dibuang tidak bisa
+    // di-unmake dan hilang dari getMoveHistory
+    void trimHistory() {
+        if (undoCount < MAX_GAME_PLY) return;
+        int keep = min(halfMoveClock, MAX_GAME_PLY / 2);
+        copy(undoStack + undoCount - keep, undoStack + undoCount, undoStack);
+        undoCount = keep;
+    }
+    
+    // Riwayat dibangun dari undo stack hanya saat diminta (bukan di hot path)
+    vector<string> getMoveHistory() const {
+        vector<string> history;
+        for (int i = 0; i < undoCount; i++) {
+            history.push_back(undoStack[i].move.toString());
+        }
+        return history;
+    }
+    
+    bool hasLegalMoves() const {
+        MoveList legalMoves;
+        generateLegalMoves(legalMoves);
+        return !legalMoves.empty();
+    }
+    
+    bool isGameOver() const {
+        return !hasLegalMoves();
+    }
+    
+    bool isCheckmate() const {
+        return isInCheck(currentPlayer) && !hasLegalMoves();
+    }
+    
+    bool isStalemate() const {
+        return !isInCheck(currentPlayer) && !hasLegalMoves();
+    }
+    
+    Move parseMove(const string& moveStr) const {
+        if (moveStr.length() < 4) return Move();
+        
+        int fromFile = moveStr[0] - 'a';
+        int fromRank = moveStr[1] - '1';
+        int toFile = moveStr[2] - 'a';
+        int toRank = moveStr[3] - '1';
+        
+        if (fromFile < 0 || fromFile > 7 || fromRank < 0 || fromRank > 7 ||
+            toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7) {
+            return Move();
+        }
+        
+        int from = fromRank * 8 + fromFile;
+        int to = toRank * 8 + toFile;
+        
+        PieceType promotion = PieceType(0);
+        if (moveStr.length() > 4) {
+            switch (tolower(moveStr[4])) {
+                case 'n': promotion = KNIGHT; break;
+                case 'b': promotion = BISHOP; break;
+                case 'r': promotion = ROOK; break;
+                case 'q': promotion = QUEEN; break;
+            }
+        }
+        
+        // Flags (capture, promosi, dsb.) diambil dari move legal yang cocok;
+        // promosi tanpa suffix dianggap promosi ke queen
+        MoveList legalMoves;
+        generateLegalMoves(legalMoves);
+        for (const Move& move : legalMoves) {
+            if (move.from() != from || move.to() != to) continue;
+            if (move.promotion() == promotion || (promotion == 0 && move.promotion() == QUEEN)) {
+                return move;
             }
         }
         
-        return moves;
+        // Tidak ada yang cocok: kembalikan move mentah supaya caller bisa melaporkan ilegal
+        return Move(from, to);
+    }
+};
+
+// Tambahkan durasi scope ke *target (nanodetik); target nullptr berarti tidak mengukur
+// sama sekali, jadi profiling yang non-aktif tidak membayar panggilan jam
+class ScopedTimer {
+    uint64_t* target;
+    steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(uint64_t* t) : target(t) {
+        if (target) start = steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (target) *target += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Counter satu search (per thread). Statistik per iterasi adalah selisih dua snapshot,
+// statistik beberapa thread atau satu benchmark adalah jumlahnya. Waktu movegen dan
+// eval hanya terisi jika profiling aktif
+struct SearchStats {
+    uint64_t nodes = 0;
+    uint64_t qNodes = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t ttCutoffs = 0;
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+    uint64_t pvsResearches = 0;       // null-window yang harus di-search ulang dengan window penuh
+    uint64_t aspirationResearches = 0;
+    uint64_t nullMoveCutoffs = 0;
+    uint64_t lmrReductions = 0;
+    uint64_t lmrResearches = 0;
+    uint64_t futilityPrunes = 0;
+    uint64_t reverseFutilityPrunes = 0;
+    uint64_t lateMovePrunes = 0;
+    uint64_t deltaPrunes = 0;         // quiescence, per node dan per move
+    uint64_t movegenNs = 0;           // generate + scoring di MovePicker
+    uint64_t evalNs = 0;
+
+    // Terapkan op ke setiap pasangan counter
+    template<typename Op>
+    void combine(const SearchStats& other, Op op) {
+        op(nodes, other.nodes);
+        op(qNodes, other.qNodes);
+        op(ttProbes, other.ttProbes);
+        op(ttHits, other.ttHits);
+        op(ttCutoffs, other.ttCutoffs);
+        op(betaCutoffs, other.betaCutoffs);
+        op(firstMoveCutoffs, other.firstMoveCutoffs);
+        op(pvsResearches, other.pvsResearches);
+        op(aspirationResearches, other.aspirationResearches);
+        op(nullMoveCutoffs, other.nullMoveCutoffs);
+        op(lmrReductions, other.lmrReductions);
+        op(lmrResearches, other.lmrResearches);
+        op(futilityPrunes, other.futilityPrunes);
+        op(reverseFutilityPrunes, other.reverseFutilityPrunes);
+        op(lateMovePrunes, other.lateMovePrunes);
+        op(deltaPrunes, other.deltaPrunes);
+        op(movegenNs, other.movegenNs);
+        op(evalNs, other.evalNs);
+    }
+
+    SearchStats& operator+=(const SearchStats& other) {
+        combine(other, [](uint64_t& a, uint64_t b) { a += b; });
+        return *this;
+    }
+
+    SearchStats operator-(const SearchStats& other) const {
+        SearchStats result = *this;
+        result.combine(other, [](uint64_t& a, uint64_t b) { a -= b; });
+        return result;
+    }
+
+    static double ratio(uint64_t part, uint64_t total) {
+        return total ? double(part) / total : 0.0;
+    }
+
+    // Field JSON tanpa kurung kurawal supaya caller bisa menambah field sendiri
+    void writeJsonFields(ostream& out, long long micros) const {
+        uint64_t total = nodes + qNodes;
+        out << fixed << setprecision(3)
+            << "\"time_ms\":" << micros / 1000.0
+            << ",\"nodes\":" << total << ",\"main_nodes\":" << nodes << ",\"qnodes\":" << qNodes
+            << ",\"nps\":" << (micros > 0 ? total * 1000000 / micros : 0)
+            << ",\"tt\":{\"probes\":" << ttProbes << ",\"hits\":" << ttHits
+            << ",\"hit_rate\":" << ratio(ttHits, ttProbes) << ",\"cutoffs\":" << ttCutoffs << "}"
+            << ",\"beta_cutoffs\":" << betaCutoffs << ",\"first_move_cutoffs\":" << firstMoveCutoffs
+            << ",\"first_move_cutoff_rate\":" << ratio(firstMoveCutoffs, betaCutoffs)
+            << ",\"movegen_ms\":" << movegenNs / 1e6 << ",\"eval_ms\":" << evalNs / 1e6
+            << ",\"prunes\":{\"null_move\":" << nullMoveCutoffs << ",\"reverse_futility\":" << reverseFutilityPrunes
+            << ",\"futility\":" << futilityPrunes << ",\"late_move\":" << lateMovePrunes
+            << ",\"delta\":" << deltaPrunes << "}"
+            << ",\"lmr\":{\"reductions\":" << lmrReductions << ",\"researches\":" << lmrResearches << "}"
+            << ",\"researches\":{\"pvs\":" << pvsResearches << ",\"aspiration\":" << aspirationResearches << "}"
+            << defaultfloat;
+    }
+};
+
+// Move picker bertahap: hash move, capture yang menang (MVV-LVA, disaring SEE),
+// killer, quiet, lalu capture yang kalah. Setiap tahap baru di-generate ketika
+// tahap sebelumnya habis, jadi cutoff di hash move tidak membayar movegen sama sekali.
+class MovePicker {
+public:
+    enum Stage { HASH_MOVE, GEN_CAPTURES, GOOD_CAPTURES, KILLERS, COUNTER_MOVE, GEN_QUIETS, QUIETS, BAD_CAPTURES, DONE };
+    
+private:
+    const ChessBoard& board;
+    Stage stage;
+    Move hashMove;
+    Move killers[2];
+    Move counterMove;
+    const int (*history)[64]; // history[from][to] untuk side to move, boleh nullptr
+    bool noisyOnly;           // quiescence: berhenti setelah capture yang tidak rugi
+    MoveList moves;
+    int index;
+    Move badCaptures[MAX_MOVES];
+    int badCount;
+    int badIndex;
+    SearchStats* profile;     // waktu movegen dicatat ke sini jika tidak nullptr
+    
+    bool isSpecial(const Move& move) const {
+        return move == hashMove || move == killers[0] || move == killers[1] || move == counterMove;
+    }
+    
+    // Quiet yang bisa dimainkan lebih awal dari stage QUIETS
+    bool isPlayableQuiet(const Move& move) const {
+        return move.isValid() && move != hashMove && !move.isCapture() &&
+               !move.isPromotion() && board.isMoveLegal(move);
+    }
+    
+    // MVV-LVA: korban paling berharga dulu, attacker termurah dulu
+    void scoreCaptures() {
+        for (int i = 0; i < moves.size(); i++) {
+            const Move& move = moves[i];
+            int victim = seeValues[board.capturedType(move)];
+            if (move.isPromotion()) victim += seeValues[move.promotion()];
+            moves.scores[i] = victim * 8 - board.getPiece(move.from()).type;
+        }
+    }
+    
+    void scoreQuiets() {
+        for (int i = 0; i < moves.size(); i++) {
+            moves.scores[i] = history ? history[moves[i].from()][moves[i].to()] : 0;
+        }
+    }
+    
+    // Generate dan scoring satu tahap
+    void generateStage(GenType type) {
+        ScopedTimer timer(profile ? &profile->movegenNs : nullptr);
+        moves.count = 0;
+        board.generateLegalMoves(moves, type);
+        if (type == GEN_NOISY) scoreCaptures();
+        else scoreQuiets();
+        index = 0;
+    }
+
+public:
+    MovePicker(const ChessBoard& b, Move ttMove, const Move* killerMoves,
+               Move counter = Move(), const int (*historyScores)[64] = nullptr)
+        : board(b), stage(HASH_MOVE), hashMove(), history(historyScores), noisyOnly(false), index(0), badCount(0), badIndex(0),
+          profile(nullptr) {
+        killers[0] = killerMoves ? killerMoves[0] : Move();
+        killers[1] = killerMoves ? killerMoves[1] : Move();
+        if (ttMove.isValid() && board.isMoveLegal(ttMove)) hashMove = ttMove;
+        counterMove = (counter != killers[0] && counter != killers[1]) ? counter : Move();
+    }
+    
+    // Picker untuk quiescence: hanya capture/promosi dengan SEE >= 0
+    explicit MovePicker(const ChessBoard& b)
+        : board(b), stage(GEN_CAPTURES), hashMove(), counterMove(), history(nullptr), noisyOnly(true),
+          index(0), badCount(0), badIndex(0), profile(nullptr) {
+        killers[0] = killers[1] = Move();
+    }
+    
+    Stage getStage() const { return stage; }
+    void setProfile(SearchStats* stats) { profile = stats; }
+    
+    // Move berikutnya, atau Move() jika sudah habis
+    Move next() {
+        switch (stage) {
+            case HASH_MOVE:
+                stage = GEN_CAPTURES;
+                if (hashMove.isValid()) return hashMove;
+                // fallthrough
+            case GEN_CAPTURES:
+                generateStage(GEN_NOISY);
+                stage = GOOD_CAPTURES;
+                // fallthrough
+            case GOOD_CAPTURES:
+                while (index < moves.size()) {
+                    Move move = moves.pickMove(index++);
+                    if (move == hashMove) continue;
+                    if (board.see(move) < 0) {
+                        badCaptures[badCount++] = move;
+                        continue;
+                    }
+                    return move;
+                }
+                if (noisyOnly) {
+                    stage = DONE;
+                    break;
+                }
+                stage = KILLERS;
+                index = 0;
+                // fallthrough
+            case KILLERS:
+                while (index < 2) {
+                    Move killer = killers[index++];
+                    if (isPlayableQuiet(killer)) return killer;
+                }
+                stage = COUNTER_MOVE;
+                // fallthrough
+            case COUNTER_MOVE:
+                stage = GEN_QUIETS;
+                if (isPlayableQuiet(counterMove)) return counterMove;
+                // fallthrough
+            case GEN_QUIETS:
+                generateStage(GEN_QUIET);
+                stage = QUIETS;
+                // fallthrough
+            case QUIETS:
+                while (index < moves.size()) {
+                    Move move = moves.pickMove(index++);
+                    if (!isSpecial(move)) return move;
+                }
+                stage = BAD_CAPTURES;
+                // fallthrough
+            case BAD_CAPTURES:
+                if (badIndex < badCount) return badCaptures[badIndex++];
+                stage = DONE;
+                // fallthrough
+            case DONE:
+                break;
+        }
+        return Move();
+    }
+};
+
+// Score mate dihitung dari jarak ply supaya mate tercepat dipilih
+const int MATE_SCORE = 9999;
+const int MATE_BOUND = MATE_SCORE - MAX_PLY;
+const int INFINITE_SCORE = MATE_SCORE + 1;
+
+enum Bound : uint8_t { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+// Hasil probe TT yang sudah di-decode
+struct TTData {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Transposition table: array power-of-two berisi bucket seukuran cache line (64 byte),
+// masing-masing 4 entry 16 byte. Entry menyimpan key XOR data (untuk verifikasi) dan
+// data yang dipack: move (16) | score (16) | depth (8) | bound (2) | age (6).
+// Dibagi antar thread tanpa lock: kedua word atomic (relaxed, jadi tetap satu mov biasa
+// di x86) dan entry yang robek karena ditulis bersamaan tidak lolos cek XOR sehingga
+// dianggap miss
+class TranspositionTable {
+private:
+    struct Entry {
+        atomic<uint64_t> key;
+        atomic<uint64_t> data;
+    };
+    
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+    
+    vector<Bucket> buckets;
+    uint64_t bucketMask;
+    uint8_t generation; // 6 bit, naik setiap search baru
+    int sizeMB;
+    
+    static uint64_t pack(Move move, int score, int depth, Bound bound, uint8_t age) {
+        return uint64_t(move.data) |
+               (uint64_t(uint16_t(int16_t(score))) << 16) |
+               (uint64_t(uint8_t(depth)) << 32) |
+               (uint64_t(bound) << 40) |
+               (uint64_t(age) << 42);
+    }
+    
+    static Move unpackMove(uint64_t data) { Move m; m.data = uint16_t(data); return m; }
+    static int unpackScore(uint64_t data) { return int16_t(uint16_t(data >> 16)); }
+    static int unpackDepth(uint64_t data) { return int(data >> 32) & 0xFF; }
+    static Bound unpackBound(uint64_t data) { return Bound((data >> 40) & 3); }
+    static uint8_t unpackAge(uint64_t data) { return uint8_t((data >> 42) & 63); }
+    
+    // Entry yang tua (generasi lama) dan dangkal paling murah untuk diganti
+    int replacementWorth(uint64_t data) const {
+        int ageDistance = (generation - unpackAge(data)) & 63;
+        return unpackDepth(data) - 8 * ageDistance;
     }
+
+public:
+    TranspositionTable() : bucketMask(0), generation(0), sizeMB(0) { resize(16); }
     
-    vector<Move> generatePieceMoves(int from, const Piece& piece) const {
-        vector<Move> moves;
-        
-        switch (piece.type) {
-            case PAWN:
-                generatePawnMoves(from, piece, moves);
-                break;
-            case KNIGHT:
-                generateKnightMoves(from, piece, moves);
-                break;
-            case BISHOP:
-                generateBishopMoves(from, piece, moves);
-                break;
-            case ROOK:
-                generateRookMoves(from, piece, moves);
-                break;
-            case QUEEN:
-                generateQueenMoves(from, piece, moves);
-                break;
-            case KING:
-                generateKingMoves(from, piece, moves);
-                break;
-        }
+    void resize(int megabytes) {
+        // Bulatkan ke bawah ke jumlah bucket power-of-two
+        uint64_t count = 1;
+        while (count * 2 * sizeof(Bucket) <= uint64_t(megabytes) * 1024 * 1024) count *= 2;
         
-        return moves;
+        buckets = vector<Bucket>(count);
+        bucketMask = count - 1;
+        sizeMB = megabytes;
+        clear();
     }
     
-    void generatePawnMoves(int from, const Piece& piece, vector<Move>& moves) const {
-        int direction = (piece.color == WHITE) ? 1 : -1;
-        int startRank = (piece.color == WHITE) ? 1 : 6;
-        int rank = from / 8;
-        int file = from % 8;
-        
-        // Forward move
-        int to = from + direction * 8;
-        if (to >= 0 && to < 64 && board[to].isEmpty()) {
-            moves.push_back(Move(from, to));
-            
-            // Double pawn move
-            if (rank == startRank) {
-                to = from + direction * 16;
-                if (to >= 0 && to < 64 && board[to].isEmpty()) {
-                    moves.push_back(Move(from, to));
-                }
+    void clear() {
+        for (Bucket& bucket : buckets) {
+            for (Entry& entry : bucket.entries) {
+                entry.key.store(0, memory_order_relaxed);
+                entry.data.store(0, memory_order_relaxed);
             }
         }
-        
-        // Captures
-        for (int df = -1; df <= 1; df += 2) {
-            if (file + df >= 0 && file + df < 8) {
-                to = from + direction * 8 + df;
-                if (to >= 0 && to < 64) {
-                    Piece target = board[to];
-                    if (!target.isEmpty() && target.color != piece.color) {
-                        Move move(from, to);
-                        move.isCapture = true;
-                        moves.push_back(move);
-                    }
-                }
+        generation = 0;
+    }
+    
+    void newSearch() { generation = (generation + 1) & 63; }
+    
+    int getSizeMB() const { return sizeMB; }
+    
+    bool probe(uint64_t key, TTData& result) const {
+        const Bucket& bucket = buckets[key & bucketMask];
+        for (const Entry& entry : bucket.entries) {
+            uint64_t data = entry.data.load(memory_order_relaxed);
+            if ((entry.key.load(memory_order_relaxed) ^ data) == key && unpackBound(data) != BOUND_NONE) {
+                result.move = unpackMove(data);
+                result.score = unpackScore(data);
+                result.depth = unpackDepth(data);
+                result.bound = unpackBound(data);
+                return true;
             }
         }
+        return false;
     }
     
-    void generateKnightMoves(int from, const Piece& piece, vector<Move>& moves) const {
-        int knightMoves[] = {-17, -15, -10, -6, 6, 10, 15, 17};
-        int file = from % 8;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound) {
+        Bucket& bucket = buckets[key & bucketMask];
+        Entry* target = &bucket.entries[0];
         
-        for (int delta : knightMoves) {
-            int to = from + delta;
-            int newFile = to % 8;
-            
-            if (to >= 0 && to < 64 && abs(file - newFile) <= 2) {
-                Piece target = board[to];
-                if (target.isEmpty() || target.color != piece.color) {
-                    Move move(from, to);
-                    move.isCapture = !target.isEmpty();
-                    moves.push_back(move);
-                }
+        for (Entry& entry : bucket.entries) {
+            // Posisi yang sama: timpa, tapi pertahankan move lama jika tidak ada yang baru
+            uint64_t data = entry.data.load(memory_order_relaxed);
+            if ((entry.key.load(memory_order_relaxed) ^ data) == key) {
+                if (!move.isValid()) move = unpackMove(data);
+                target = &entry;
+                break;
+            }
+            if (replacementWorth(data) < replacementWorth(target->data.load(memory_order_relaxed))) {
+                target = &entry;
             }
         }
+        
+        uint64_t data = pack(move, score, max(0, depth), bound, generation);
+        target->key.store(key ^ data, memory_order_relaxed);
+        target->data.store(data, memory_order_relaxed);
     }
     
-    void generateBishopMoves(int from, const Piece& piece, vector<Move>& moves) const {
-        int directions[] = {-9, -7, 7, 9};
-        
-        for (int dir : directions) {
-            int to = from + dir;
-            while (to >= 0 && to < 64) {
-                // Check for board edge
-                if (abs((to % 8) - (from % 8)) != abs((to / 8) - (from / 8))) break;
-                
-                Piece target = board[to];
-                if (target.isEmpty()) {
-                    moves.push_back(Move(from, to));
-                } else {
-                    if (target.color != piece.color) {
-                        Move move(from, to);
-                        move.isCapture = true;
-                        moves.push_back(move);
-                    }
-                    break;
-                }
-                to += dir;
+    // Permill entry yang terisi dari generasi sekarang (sample 1000 entry pertama)
+    int hashfull() const {
+        int used = 0, sampled = 0;
+        for (size_t i = 0; i < buckets.size() && i < 250; i++) {
+            for (const Entry& entry : buckets[i].entries) {
+                sampled++;
+                uint64_t data = entry.data.load(memory_order_relaxed);
+                if (unpackBound(data) != BOUND_NONE && unpackAge(data) == generation) used++;
             }
         }
+        return sampled ? used * 1000 / sampled : 0;
     }
+};
+
+// Mate score disimpan relatif terhadap node, bukan root
+inline int scoreToTT(int score, int ply) {
+    if (score > MATE_BOUND) return score + ply;
+    if (score < -MATE_BOUND) return score - ply;
+    return score;
+}
+
+inline int scoreFromTT(int score, int ply) {
+    if (score > MATE_BOUND) return score - ply;
+    if (score < -MATE_BOUND) return score + ply;
+    return score;
+}
+
+// Hasil evaluasi struktur pawn (perspektif WHITE) yang hanya bergantung pada posisi pawn
+struct PawnEntry {
+    uint64_t key;
+    int16_t mg, eg;
+    Bitboard passed[2];
+};
+
+// Bonus passed pawn per rank relatif (rank 2..7)
+constexpr int passedBonusMg[8] = {0, 5, 10, 15, 25, 40, 60, 0};
+constexpr int passedBonusEg[8] = {0, 10, 20, 35, 60, 100, 150, 0};
+
+inline void evaluatePawnStructure(const ChessBoard& board, PawnEntry& entry) {
+    int mg = 0, eg = 0;
     
-    void generateRookMoves(int from, const Piece& piece, vector<Move>& moves) const {
-        int directions[] = {-8, -1, 1, 8};
+    for (int c = WHITE; c <= BLACK; c++) {
+        Color color = Color(c), them = Color(1 - c);
+        int sign = (color == WHITE) ? 1 : -1;
+        Bitboard ours = board.getPieces(color, PAWN);
+        Bitboard theirs = board.getPieces(them, PAWN);
+        entry.passed[color] = 0;
         
-        for (int dir : directions) {
-            int to = from + dir;
-            while (to >= 0 && to < 64) {
-                // Check for board edge
-                if (dir == -1 && to % 8 == 7) break;
-                if (dir == 1 && to % 8 == 0) break;
-                
-                Piece target = board[to];
-                if (target.isEmpty()) {
-                    moves.push_back(Move(from, to));
-                } else {
-                    if (target.color != piece.color) {
-                        Move move(from, to);
-                        move.isCapture = true;
-                        moves.push_back(move);
-                    }
-                    break;
-                }
-                to += dir;
+        Bitboard pawns = ours;
+        while (pawns) {
+            int square = popLsb(pawns);
+            int file = square % 8;
+            int relativeRank = (color == WHITE) ? square / 8 : 7 - square / 8;
+            int stop = square + (color == WHITE ? 8 : -8);
+            Bitboard neighbours = ours & adjacentFilesBB(file);
+            
+            // Doubled: masih ada pawn sendiri di depan pada file yang sama
+            if (ours & passedPawnMask[color][square] & fileBB(file)) {
+                mg -= sign * 10;
+                eg -= sign * 20;
+            }
+            
+            if (!neighbours) {
+                // Isolated: tidak ada pawn sendiri di file sebelah
+                mg -= sign * 10;
+                eg -= sign * 15;
+            } else if (!(neighbours & ~passedPawnMask[color][square]) &&
+                       (pawnAttacks[color][stop] & theirs)) {
+                // Backward: semua tetangga sudah lebih maju dan stop square dijaga pawn lawan
+                mg -= sign * 8;
+                eg -= sign * 10;
+            }
+            
+            if (!(theirs & passedPawnMask[color][square])) {
+                entry.passed[color] |= squareBB(square);
+                mg += sign * passedBonusMg[relativeRank];
+                eg += sign * passedBonusEg[relativeRank];
             }
         }
     }
     
-    void generateQueenMoves(int from, const Piece& piece, vector<Move>& moves) const {
-        generateBishopMoves(from, piece, moves);
-        generateRookMoves(from, piece, moves);
+    entry.key = board.getPawnKey();
+    entry.mg = int16_t(mg);
+    entry.eg = int16_t(eg);
+}
+
+// Cache struktur pawn dengan key Zobrist pawn saja. Struktur pawn jarang berubah di
+// dalam tree, jadi hit rate-nya tinggi. Satu tabel per thread supaya tidak perlu sinkronisasi
+class PawnHashTable {
+private:
+    vector<PawnEntry> entries;
+    uint64_t indexMask;
+    uint64_t probes;
+    uint64_t hits;
+
+public:
+    explicit PawnHashTable(int sizeLog2 = 14) : probes(0), hits(0) {
+        entries.resize(size_t(1) << sizeLog2);
+        indexMask = entries.size() - 1;
+        clear();
+    }
+    
+    // Entry key 0 dengan skor 0 juga benar untuk posisi tanpa pawn
+    void clear() {
+        for (PawnEntry& entry : entries) entry = PawnEntry{0, 0, 0, {0, 0}};
     }
     
-    void generateKingMoves(int from, const Piece& piece, vector<Move>& moves) const {
-        int directions[] = {-9, -8, -7, -1, 1, 7, 8, 9};
-        
-        for (int dir : directions) {
-            int to = from + dir;
-            if (to >= 0 && to < 64 && abs((to % 8) - (from % 8)) <= 1) {
-                Piece target = board[to];
-                if (target.isEmpty() || target.color != piece.color) {
-                    Move move(from, to);
-                    move.isCapture = !target.isEmpty();
-                    moves.push_back(move);
-                }
-            }
+    void resetStats() { probes = hits = 0; }
+    uint64_t getProbes() const { return probes; }
+    uint64_t getHits() const { return hits; }
+    
+    const PawnEntry& probe(const ChessBoard& board) {
+        uint64_t key = board.getPawnKey();
+        PawnEntry& entry = entries[key & indexMask];
+        probes++;
+        if (entry.key == key) {
+            hits++;
+        } else {
+            evaluatePawnStructure(board, entry);
         }
+        return entry;
+    }
+};
+
+// ===== Search trace =====
+// Tracing adalah policy compile-time dari negamax: build biasa memakai NoTrace sehingga
+// tidak ada kode trace sama sekali di search. Build dengan -DSEARCH_TRACE menulis record
+// biner berukuran tetap ke ring buffer yang disimpan ke file setelah search; file itu
+// di-render terpisah dengan --render-trace (teks atau DOT)
+struct NoTrace { static constexpr bool enabled = false; };
+struct RecordTrace { static constexpr bool enabled = true; };
+
+#if defined(SEARCH_TRACE)
+using SearchTrace = RecordTrace;
+#else
+using SearchTrace = NoTrace;
+#endif
+
+enum TraceEvent : uint8_t {
+    TRACE_ITERATION,   // awal iterasi, depth = depth iterasi
+    TRACE_ENTER,       // masuk node: move yang mengarah ke node, window awal
+    TRACE_PV, TRACE_CUT, TRACE_ALL, // keluar node setelah mencari move (move = best move)
+    TRACE_DRAW, TRACE_STOPPED, TRACE_TT_CUTOFF, TRACE_LEAF,
+    TRACE_RFP_CUTOFF, TRACE_NULL_CUTOFF, TRACE_NO_MOVES,
+    TRACE_EVENT_COUNT
+};
+
+const char* const traceEventNames[TRACE_EVENT_COUNT] = {
+    "ITERATION", "ENTER", "PV", "CUT", "ALL", "DRAW", "STOPPED", "TT_CUTOFF", "LEAF",
+    "RFP_CUTOFF", "NULL_CUTOFF", "NO_MOVES"
+};
+
+// Score dan window dari perspektif side to move di node tersebut
+struct TraceRecord {
+    uint16_t move;
+    int16_t score;
+    int16_t alpha;
+    int16_t beta;
+    uint8_t ply;
+    uint8_t depth;
+    uint8_t event;
+    uint8_t side;
+};
+static_assert(sizeof(TraceRecord) == 12, "TraceRecord harus berukuran tetap");
+
+const char TRACE_MAGIC[8] = {'S', 'C', 'E', 'T', 'R', 'A', 'C', 'E'};
+const string TRACE_FILE = "search_trace.bin";
+
+// Ring buffer record trace; saat penuh record paling lama ditimpa
+class TraceBuffer {
+private:
+    vector<TraceRecord> records;
+    size_t next;
+    uint64_t total;
+
+public:
+    static constexpr size_t CAPACITY = size_t(1) << 20; // 12 MB
+    
+    TraceBuffer() : next(0), total(0) {}
+    
+    void clear() {
+        records.resize(CAPACITY); // dialokasikan sekali, di luar search
+        next = 0;
+        total = 0;
     }
     
-    bool isMoveLegal(const Move& move) const {
-        // Make a copy and test the move
-        ChessBoard testBoard = *this;
-        testBoard.makeMove(move);
-        return !testBoard.isInCheck(currentPlayer);
+    void push(const TraceRecord& record) {
+        records[next] = record;
+        next = (next + 1) & (CAPACITY - 1);
+        total++;
     }
     
-    bool makeMove(const Move& move) {
-        if (!move.isValid()) return false;
-        
-        Piece movingPiece = board[move.from];
-        Piece capturedPiece = board[move.to];
-        
-        // Update king position
-        if (movingPiece.type == KING) {
-            kingPositions[movingPiece.color] = move.to;
+    uint64_t getTotal() const { return total; }
+    
+    // Format: magic "SCETRACE", uint64 jumlah record, lalu record urut kronologis
+    bool save(const string& path) const {
+        ofstream file(path, ios::binary);
+        if (!file) return false;
+        uint64_t count = min<uint64_t>(total, CAPACITY);
+        size_t first = (total > CAPACITY) ? next : 0;
+        file.write(TRACE_MAGIC, 8);
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (uint64_t i = 0; i < count; i++) {
+            file.write(reinterpret_cast<const char*>(&records[(first + i) & (CAPACITY - 1)]), sizeof(TraceRecord));
         }
-        
-        // Make the move
-        board[move.to] = movingPiece;
-        board[move.from] = Piece();
-        
-        // Switch players
-        currentPlayer = Color(1 - currentPlayer);
-        
-        // Add to history
-        moveHistory.push_back(move.toString());
-        
-        return true;
+        return bool(file);
     }
+};
+
+// State search per thread untuk Lazy SMP: board, tabel ordering dan counter milik
+// thread sendiri; yang dibagi antar thread hanya TT dan flag stop
+struct SearchThread {
+    int id;
+    ChessBoard board;
     
-    bool isGameOver() const {
-        vector<Move> legalMoves = generateLegalMoves();
-        return legalMoves.empty();
+    // Ordering quiet move: killer per ply, history [color][from][to], countermove
+    Move killers[MAX_PLY][2];
+    int historyTable[2][64][64];
+    Move counterMoves[2][64][64]; // dibalas oleh side to move, diindeks move lawan sebelumnya
+    
+    PawnHashTable pawnTable;
+    SearchStats stats;
+    
+    int completedDepth;
+    Move bestMove;
+    int bestScore; // perspektif WHITE, untuk ditampilkan
+    
+    explicit SearchThread(int threadId = 0) : id(threadId) {
+        clearOrderingTables();
+        resetStats();
     }
     
-    bool isCheckmate() const {
-        return isInCheck(currentPlayer) && generateLegalMoves().empty();
+    bool isMain() const { return id == 0; }
+    
+    void resetStats() {
+        stats = SearchStats();
+        pawnTable.resetStats();
+        completedDepth = 0;
+        bestMove = Move();
+        bestScore = 0;
     }
     
-    bool isStalemate() const {
-        return !isInCheck(currentPlayer) && generateLegalMoves().empty();
+    void clearOrderingTables() {
+        for (auto& slots : killers) slots[0] = slots[1] = Move();
+        for (int c = 0; c < 2; c++)
+            for (int from = 0; from < 64; from++)
+                for (int to = 0; to < 64; to++) {
+                    historyTable[c][from][to] = 0;
+                    counterMoves[c][from][to] = Move();
+                }
     }
     
-    Move parseMove(const string& moveStr) const {
-        if (moveStr.length() < 4) return Move();
-        
-        int fromFile = moveStr[0] - 'a';
-        int fromRank = moveStr[1] - '1';
-        int toFile = moveStr[2] - 'a';
-        int toRank = moveStr[3] - '1';
-        
-        if (fromFile < 0 || fromFile > 7 || fromRank < 0 || fromRank > 7 ||
-            toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7) {
-            return Move();
-        }
-        
-        int from = fromRank * 8 + fromFile;
-        int to = toRank * 8 + toFile;
-        
-        return Move(from, to);
+    // Killer hanya berlaku untuk posisi saat ini; history di-age supaya search baru
+    // tidak didominasi statistik dari posisi lama
+    void ageOrderingTables() {
+        for (auto& slots : killers) slots[0] = slots[1] = Move();
+        for (auto& side : historyTable)
+            for (auto& row : side)
+                for (int& entry : row) entry /= 2;
     }
 };
 
 class ChessEngine {
 private:
-    unordered_map<string, pair<int, int>> transpositionTable;
-    int nodesSearched;
-    steady_clock::time_point startTime;
+    TranspositionTable tt;
+    atomic<bool> searchStopped; // waktu habis / thread utama selesai; hasil tidak boleh masuk TT
+    
+    // Lazy SMP: threads[0] adalah thread utama, sisanya helper
+    static constexpr int MAX_THREADS = 256;
+    int threadCount;
+    vector<SearchThread> threads;
+    
+    static constexpr int HISTORY_MAX = 16384;
+    bool useOrderingHeuristics;
+    bool useNnue; // evaluasi dengan nnueNet menggantikan evaluasi klasik
+    
+    static constexpr int DELTA_MARGIN = 200;
+    static constexpr int ASPIRATION_DELTA = 25;
+    
+    // Late move reductions
+    int lmrTable[64][64]; // [depth][nomor move] -> reduksi dalam ply
+    
+    // Frontier pruning; margin dalam centipawn per ply sisa depth
+    int futilityMargin;
+    int reverseFutilityMargin;
+    int lmpBase; // quiet move yang dicari di depth d: lmpBase + d*d
+    
+    // Ringkasan search terakhir (semua thread)
+    SearchStats lastSearchStats;
+    long long lastSearchTime;
+    int lastCompletedDepth;
+    
+    // Statistik JSON: satu baris per iterasi thread utama dan satu per search. Selama
+    // output aktif, waktu movegen dan eval ikut diukur
+    static constexpr const char* STATS_FILE = "search_stats.jsonl";
+    ostream* statsOut; // nullptr = non-aktif
+    ofstream statsFile;
+    
+    // Waktu mulai search sebagai tick steady_clock; atomic karena di-reset thread UI saat
+    // ponder hit sementara thread search membacanya
+    atomic<steady_clock::rep> startTicks;
     int timeLimit; // in milliseconds
+    
+    // Time management: soft limit hanya dicek di antara iterasi dan diskalakan dengan
+    // stabilitas best move; hard limit dicek thread utama setiap TIME_CHECK_INTERVAL node
+    static constexpr uint64_t TIME_CHECK_INTERVAL = 1024;
+    long long softLimit;
+    long long hardLimit;
+    
+    // Batas tambahan dari perintah UCI go; 0 berarti tidak dipakai
+    long long clockTime;      // sisa waktu side to move
+    long long clockIncrement;
+    int movesToGo;
+    uint64_t nodeLimit;       // node thread utama
+    bool infiniteSearch;      // bestmove baru dikirim setelah stop
+    bool fixedMoveTime;       // go movetime: soft = hard, tanpa berhenti lebih awal
+    bool uciOutput;           // baris info/bestmove UCI dari thread worker
+    thread searchWorker; // thread utama search, dijalankan startSearch
+    bool quietSearch;    // tanpa output per iterasi (ponder)
+    
+    // Ponder: search di posisi setelah balasan lawan yang diprediksi (atau posisi lawan
+    // untuk semua balasan) selama pemain berpikir. Saat ponder hit, soft/hard limit dihitung
+    // ulang mulai dari hit; tree ponder tetap dipakai, jadi iterasi berikutnya langsung lebih dalam
+    atomic<bool> pondering;
+    atomic<steady_clock::rep> iterationEndTicks; // perkiraan selesai iterasi thread utama, 0 = belum ada
+    uint64_t ponderKey;
+    Move ponderMove;
+    bool usePonder;
     int maxDepth;
-    bool showTree;
+    bool showTree; // trace search, hanya ada di build -DSEARCH_TRACE
+    TraceBuffer traceBuffer;
     bool useTimeLimit;
     bool enableMoveAnalysis;
     bool debugMode; // Untuk menampilkan debug info
     
-    int pieceValues[7] = {0, 100, 320, 330, 500, 900, 20000};
+    static constexpr int MOBILITY_WEIGHT = 2;
+    static constexpr int SHIELD_BONUS_NEAR = 15;
+    static constexpr int SHIELD_BONUS_FAR = 8;
     
     // Move analysis history
     struct MoveAnalysis {
@@ -487,8 +2578,31 @@ private:
     int lastEvaluation;
 
 public:
-    ChessEngine() : nodesSearched(0), timeLimit(5000), maxDepth(5), showTree(false), 
-                    useTimeLimit(true), enableMoveAnalysis(true), debugMode(false), lastEvaluation(0) {}
+    static constexpr int MOVE_OVERHEAD_MS = 20; // cadangan komunikasi dengan GUI (mode UCI)
+    
+    ChessEngine() : searchStopped(false), threadCount(0), useOrderingHeuristics(true), useNnue(false),
+                    futilityMargin(150), reverseFutilityMargin(100), lmpBase(3),
+                    lastSearchTime(0), lastCompletedDepth(0), statsOut(nullptr),
+                    startTicks(0), timeLimit(5000), softLimit(0), hardLimit(0),
+                    clockTime(0), clockIncrement(0), movesToGo(0), nodeLimit(0), infiniteSearch(false), fixedMoveTime(false), uciOutput(false),
+                    quietSearch(false),
+                    pondering(false), iterationEndTicks(0), ponderKey(0), usePonder(true), maxDepth(5), showTree(false), 
+                    useTimeLimit(true), enableMoveAnalysis(true), debugMode(false), lastEvaluation(0) {
+        setThreadCount(1);
+        
+        // Reduksi tumbuh logaritmik terhadap depth dan urutan move
+        for (int depth = 0; depth < 64; depth++) {
+            for (int moveNumber = 0; moveNumber < 64; moveNumber++) {
+                lmrTable[depth][moveNumber] = (depth == 0 || moveNumber == 0) ? 0 :
+                    int(0.75 + log(double(depth)) * log(double(moveNumber)) / 2.25);
+            }
+        }
+    }
+    
+    ~ChessEngine() {
+        stopSearch();
+        if (searchWorker.joinable()) searchWorker.join();
+    }
     
     void showConfig() const {
         cout << "\n📊 KONFIGURASI ENGINE" << endl;
@@ -499,6 +2613,14 @@ public:
         cout << "• Tampilkan tree      : " << (showTree ? "Ya" : "Tidak") << endl;
         cout << "• Analisis gerakan    : " << (enableMoveAnalysis ? "Aktif" : "Non-aktif") << endl;
         cout << "• Debug mode          : " << (debugMode ? "Aktif" : "Non-aktif") << endl;
+        cout << "• Ukuran hash         : " << tt.getSizeMB() << " MB" << endl;
+        cout << "• Killer/history      : " << (useOrderingHeuristics ? "Aktif" : "Non-aktif") << endl;
+        cout << "• Thread              : " << threadCount << endl;
+        cout << "• Ponder              : " << (usePonder ? "Aktif" : "Non-aktif") << endl;
+        cout << "• Statistik JSON      : " << (statsOut ? string("Aktif (") + STATS_FILE + ")" : string("Non-aktif")) << endl;
+        cout << "• Evaluasi            : " << (useNnue ? "NNUE, network " + nnueNet->getSource() : string("Klasik")) << endl;
+        cout << "• Margin pruning      : futility " << futilityMargin << ", reverse " << reverseFutilityMargin
+             << ", LMP " << lmpBase << endl;
         cout << "═══════════════════════\n" << endl;
     }
     
@@ -513,11 +2635,18 @@ public:
             cout << "4. Toggle tampilan tree (" << (showTree ? "Ya" : "Tidak") << ")" << endl;
             cout << "5. Toggle analisis gerakan (" << (enableMoveAnalysis ? "Aktif" : "Non-aktif") << ")" << endl;
             cout << "6. Toggle debug mode (" << (debugMode ? "Aktif" : "Non-aktif") << ")" << endl;
-            cout << "7. Lihat riwayat analisis" << endl;
-            cout << "8. Reset ke default" << endl;
-            cout << "9. Kembali ke permainan" << endl;
+            cout << "7. Ubah ukuran hash (" << tt.getSizeMB() << " MB)" << endl;
+            cout << "8. Toggle killer/history ordering (" << (useOrderingHeuristics ? "Aktif" : "Non-aktif") << ")" << endl;
+            cout << "9. Ubah margin pruning (" << futilityMargin << "/" << reverseFutilityMargin << "/" << lmpBase << ")" << endl;
+            cout << "10. Ubah jumlah thread (" << threadCount << ")" << endl;
+            cout << "11. Toggle evaluasi NNUE (" << (useNnue ? "Aktif" : "Non-aktif") << ")" << endl;
+            cout << "12. Toggle ponder (" << (usePonder ? "Aktif" : "Non-aktif") << ")" << endl;
+            cout << "13. Toggle statistik JSON (" << (statsOut ? "Aktif" : "Non-aktif") << ")" << endl;
+            cout << "14. Lihat riwayat analisis" << endl;
+            cout << "15. Reset ke default" << endl;
+            cout << "16. Kembali ke permainan" << endl;
             cout << "════════════════════" << endl;
-            cout << "Pilih (1-9): ";
+            cout << "Pilih (1-16): ";
             
             if (!(cin >> choice)) {
                 cin.clear();
@@ -557,10 +2686,14 @@ public:
                     cout << "✓ Mode waktu: " << (useTimeLimit ? "Aktif" : "Non-aktif") << endl;
                     break;
                 case 4:
+                    if (!SearchTrace::enabled) {
+                        cout << "❌ Build ini tanpa trace search; compile ulang dengan -DSEARCH_TRACE" << endl;
+                        break;
+                    }
                     showTree = !showTree;
-                    cout << "✓ Tampilan tree: " << (showTree ? "Aktif" : "Non-aktif") << endl;
+                    cout << "✓ Trace search: " << (showTree ? "Aktif" : "Non-aktif") << endl;
                     if (showTree) {
-                        cout << "⚠️  Peringatan: Tree akan ditampilkan, output bisa sangat panjang!" << endl;
+                        cout << "🌳 Tree disimpan ke " << TRACE_FILE << " setelah setiap search" << endl;
                     }
                     break;
                 case 5:
@@ -577,19 +2710,103 @@ public:
                         cout << "🔍 Debug info akan ditampilkan untuk analisis gerakan!" << endl;
                     }
                     break;
-                case 7:
-                    showMoveHistory();
+                case 7: {
+                    cout << "Masukkan ukuran hash dalam MB (1-16384): ";
+                    int newSize;
+                    if (cin >> newSize && newSize >= 1 && newSize <= 16384) {
+                        tt.resize(newSize);
+                        cout << "✓ Ukuran hash diubah ke " << tt.getSizeMB() << " MB" << endl;
+                    } else {
+                        cout << "❌ Ukuran hash harus antara 1-16384 MB!" << endl;
+                    }
+                    cin.ignore();
                     break;
+                }
                 case 8:
+                    useOrderingHeuristics = !useOrderingHeuristics;
+                    for (SearchThread& td : threads) td.clearOrderingTables();
+                    cout << "✓ Killer/history ordering: " << (useOrderingHeuristics ? "Aktif" : "Non-aktif") << endl;
+                    break;
+                case 9: {
+                    cout << "Masukkan margin futility, reverse futility (0-1000 cp per ply) dan basis LMP (0-64): ";
+                    int newFutility, newReverse, newLmp;
+                    if (cin >> newFutility >> newReverse >> newLmp &&
+                        newFutility >= 0 && newFutility <= 1000 && newReverse >= 0 && newReverse <= 1000 &&
+                        newLmp >= 0 && newLmp <= 64) {
+                        futilityMargin = newFutility;
+                        reverseFutilityMargin = newReverse;
+                        lmpBase = newLmp;
+                        cout << "✓ Margin pruning diubah ke " << futilityMargin << "/" << reverseFutilityMargin
+                             << "/" << lmpBase << endl;
+                    } else {
+                        cin.clear();
+                        cout << "❌ Margin harus antara 0-1000 dan basis LMP antara 0-64!" << endl;
+                    }
+                    cin.ignore(10000, '\n');
+                    break;
+                }
+                case 10: {
+                    cout << "Masukkan jumlah thread (1-" << MAX_THREADS << ", core tersedia: "
+                         << thread::hardware_concurrency() << "): ";
+                    int newThreads;
+                    if (cin >> newThreads && newThreads >= 1 && newThreads <= MAX_THREADS) {
+                        setThreadCount(newThreads);
+                        cout << "✓ Jumlah thread diubah ke " << threadCount << endl;
+                    } else {
+                        cin.clear();
+                        cout << "❌ Jumlah thread harus antara 1-" << MAX_THREADS << "!" << endl;
+                    }
+                    cin.ignore(10000, '\n');
+                    break;
+                }
+                case 11:
+                    setUseNnue(!useNnue);
+                    cout << "✓ Evaluasi NNUE: " << (useNnue ? "Aktif (network " + nnueNet->getSource() + ")" : string("Non-aktif")) << endl;
+                    break;
+                case 12:
+                    usePonder = !usePonder;
+                    cout << "✓ Ponder: " << (usePonder ? "Aktif" : "Non-aktif") << endl;
+                    break;
+                case 13:
+                    if (statsOut) {
+                        statsFile.close();
+                        statsOut = nullptr;
+                        cout << "✓ Statistik JSON: Non-aktif" << endl;
+                        break;
+                    }
+                    statsFile.open(STATS_FILE, ios::app);
+                    if (!statsFile) {
+                        statsFile.clear();
+                        cout << "❌ Gagal membuka " << STATS_FILE << endl;
+                        break;
+                    }
+                    statsOut = &statsFile;
+                    cout << "✓ Statistik JSON: Aktif" << endl;
+                    cout << "📈 Satu baris per iterasi dan per search ditambahkan ke " << STATS_FILE << endl;
+                    break;
+                case 14:
+                    showMoveHistory();
+                    break;
+                case 15:
                     maxDepth = 5;
                     timeLimit = 5000;
                     useTimeLimit = true;
                     showTree = false;
                     enableMoveAnalysis = true;
                     debugMode = false;
+                    tt.resize(16);
+                    useOrderingHeuristics = true;
+                    setThreadCount(1);
+                    futilityMargin = 150;
+                    reverseFutilityMargin = 100;
+                    lmpBase = 3;
+                    useNnue = false;
+                    usePonder = true;
+                    if (statsOut == &statsFile) statsFile.close();
+                    statsOut = nullptr;
                     cout << "✓ Konfigurasi di-reset ke default" << endl;
                     break;
-                case 9:
+                case 16:
                     return;
                 default:
                     cout << "❌ Pilihan tidak valid!" << endl;
@@ -731,16 +2948,17 @@ public:
         return badge + " | " + description;
     }
     
-    int rankMove(const ChessBoard& board, const Move& playerMove) {
-        vector<Move> allMoves = board.generateLegalMoves();
+    int rankMove(ChessBoard& board, const Move& playerMove) {
+        MoveList allMoves;
+        board.generateLegalMoves(allMoves);
         vector<pair<int, Move>> moveScores;
         
         // Evaluasi semua gerakan dari perspektif current player
         for (const Move& move : allMoves) {
-            ChessBoard testBoard = board;
-            testBoard.makeMove(move);
+            board.makeMove(move);
             // Evaluasi dari perspektif lawan, jadi negate untuk perspektif current player
-            int score = -evaluateBoard(testBoard);
+            int score = -evaluateWithTerminal(board);
+            board.unmakeMove();
             moveScores.push_back({score, move});
         }
         
@@ -759,8 +2977,7 @@ public:
         
         // Cari ranking gerakan pemain
         for (size_t i = 0; i < moveScores.size(); i++) {
-            if (moveScores[i].second.from == playerMove.from && 
-                moveScores[i].second.to == playerMove.to) {
+            if (moveScores[i].second == playerMove) {
                 if (debugMode) {
                     cout << "Debug - Player move " << playerMove.toString() << " ranked #" << (i+1) << " with score " << moveScores[i].first << endl;
                 }
@@ -778,30 +2995,27 @@ public:
         if (!enableMoveAnalysis) return;
         
         // Evaluasi posisi sebelum gerakan (dari perspektif current player)
-        int scoreBefore = evaluateBoard(board);
+        int scoreBefore = evaluateWithTerminal(board);
         
         // Buat gerakan dan evaluasi posisi setelah gerakan
-        ChessBoard newBoard = board;
-        newBoard.makeMove(playerMove);
+        board.makeMove(playerMove);
         
         // Evaluasi posisi setelah gerakan (sekarang perspektif lawan)
         // Jadi kita perlu negate untuk mendapat perspektif asli
-        int scoreAfter = -evaluateBoard(newBoard);
+        int scoreAfter = -evaluateWithTerminal(board);
+        bool isCheck = board.isInCheck(board.getCurrentPlayer());
+        board.unmakeMove();
         
         // Hitung score difference (positif = bagus untuk pemain)
         int scoreDiff = scoreAfter - scoreBefore;
         
         // Rank gerakan pemain dibandingkan semua gerakan legal
         int rank = rankMove(board, playerMove);
-        vector<Move> allMoves = board.generateLegalMoves();
+        MoveList allMoves;
+        board.generateLegalMoves(allMoves);
         
         // Cek properti gerakan
-        Piece capturedPiece = board.getPiece(playerMove.to);
-        bool isCapture = !capturedPiece.isEmpty();
-        
-        newBoard = board;
-        newBoard.makeMove(playerMove);
-        bool isCheck = newBoard.isInCheck(newBoard.getCurrentPlayer());
+        bool isCapture = playerMove.isCapture();
         
         // Analisis kualitas
         string analysis = analyzeMoveQuality(scoreDiff, rank, allMoves.size(), isCapture, isCheck);
@@ -846,244 +3060,882 @@ public:
         lastEvaluation = scoreAfter;
     }
     
-    string getIndent(int depth) const {
-        string indent = "";
-        for (int i = 0; i < depth; i++) {
-            indent += (i == depth - 1) ? "├─ " : "│  ";
-        }
-        return indent;
+    // Hanya dipanggil dari instansiasi RecordTrace (thread utama)
+    void traceNode(TraceEvent event, int ply, int depth, Move move, int score, int alpha, int beta, Color side) {
+        traceBuffer.push({move.data, int16_t(score), int16_t(alpha), int16_t(beta),
+                          uint8_t(ply), uint8_t(depth), uint8_t(event), uint8_t(side)});
     }
     
-    void printTreeNode(int depth, const Move& move, int score, bool isMaximizing, 
-                      int alpha, int beta, const string& nodeType = "") const {
-        if (!showTree) return;
+    // Evaluasi statis tanpa move generation (atau NNUE jika diaktifkan): material + PST tapered (di-update
+    // incremental oleh board), struktur pawn dari pawn hash, pawn shield dan mobility
+    // pseudo-legal dari attack mask. Mate/stalemate dideteksi search dari move list-nya
+    // sendiri. Tanpa pawnTable struktur pawn dihitung langsung. Score dari perspektif
+    // current player
+    int evaluateBoard(const ChessBoard& board, PawnHashTable* pawnTable = nullptr) const {
+        if (useNnue) {
+            return nnueNet->evaluate(board.getAccumulator(), board.getCurrentPlayer(), board.getGamePhase());
+        }
         
-        string indent = getIndent(depth);
-        string player = isMaximizing ? "MAX" : "MIN";
-        string moveStr = move.isValid() ? move.toString() : "root";
+        PawnEntry local;
+        const PawnEntry* pawns = &local;
+        if (pawnTable) pawns = &pawnTable->probe(board);
+        else evaluatePawnStructure(board, local);
         
-        cout << indent << player << " d=" << depth << " | " << moveStr 
-             << " | Score=" << score << " | α=" << alpha << " β=" << beta;
+        int mg = pawns->mg, eg = pawns->eg;
+        int score = board.taperedPsqt();
+        Bitboard occupied = board.getOccupied();
         
-        if (!nodeType.empty()) {
-            cout << " [" << nodeType << "]";
+        for (int c = WHITE; c <= BLACK; c++) {
+            Color color = Color(c);
+            int sign = (color == WHITE) ? 1 : -1;
+            Bitboard notOwn = ~board.getPieces(color);
+            Bitboard ownPawns = board.getPieces(color, PAWN);
+            
+            // Pawn shield: pawn sendiri di dua rank depan raja (file raja dan sebelahnya);
+            // bergantung posisi raja sehingga tidak ikut di-cache
+            int kingSquare = lsb(board.getPieces(color, KING));
+            int kingRank = kingSquare / 8;
+            int forward = (color == WHITE) ? 1 : -1;
+            Bitboard shield = ownPawns & passedPawnMask[color][kingSquare];
+            if (kingRank + forward >= 0 && kingRank + forward < 8) {
+                mg += sign * SHIELD_BONUS_NEAR * popCount(shield & rankBB(kingRank + forward));
+            }
+            if (kingRank + 2 * forward >= 0 && kingRank + 2 * forward < 8) {
+                mg += sign * SHIELD_BONUS_FAR * popCount(shield & rankBB(kingRank + 2 * forward));
+            }
+            
+            // Passed pawn yang jalannya tidak diblokir lebih berbahaya di endgame
+            Bitboard passed = pawns->passed[color];
+            while (passed) {
+                int square = popLsb(passed);
+                int stop = square + 8 * forward;
+                if (!(occupied & squareBB(stop))) {
+                    int relativeRank = (color == WHITE) ? square / 8 : 7 - square / 8;
+                    eg += sign * 5 * relativeRank;
+                }
+            }
+            
+            for (int type = KNIGHT; type <= QUEEN; type++) {
+                Bitboard pieces = board.getPieces(color, PieceType(type));
+                
+                // Mobility: square yang diserang dan tidak ditempati piece sendiri
+                Piece piece(PieceType(type), color);
+                while (pieces) {
+                    int square = popLsb(pieces);
+                    score += sign * MOBILITY_WEIGHT * popCount(board.pieceAttacks(square, piece, occupied) & notOwn);
+                }
+            }
         }
         
-        cout << endl;
+        score += board.taper(mg, eg);
+        return (board.getCurrentPlayer() == WHITE) ? score : -score;
+    }
+    
+    // Untuk analisis di luar search, di mana tidak ada move list untuk mendeteksi mate
+    int evaluateWithTerminal(const ChessBoard& board) const {
+        return board.hasLegalMoves() ? evaluateBoard(board) : terminalScore(board, 0);
+    }
+    
+    // Checkmate / stalemate dari perspektif side to move; mate lebih dekat bernilai lebih besar
+    int terminalScore(const ChessBoard& board, int ply) const {
+        return board.isInCheck(board.getCurrentPlayer()) ? -(MATE_SCORE - ply) : 0;
+    }
+    
+    // Tabel thread dibuat ulang; dipanggil di luar search
+    void setThreadCount(int count) {
+        threadCount = max(1, min(count, MAX_THREADS));
+        threads.clear();
+        threads.reserve(threadCount);
+        for (int i = 0; i < threadCount; i++) threads.emplace_back(i);
+    }
+    
+    // Untuk benchmark dan mode non-interaktif; 0 ms berarti tanpa batas waktu
+    void setMaxDepth(int depth) { maxDepth = depth; }
+    void setTimeLimit(int milliseconds) {
+        useTimeLimit = milliseconds > 0;
+        if (milliseconds > 0) timeLimit = milliseconds;
+        fixedMoveTime = false;
+    }
+    
+    // Mode UCI go movetime: search memakai seluruh waktu (dikurangi overhead komunikasi)
+    void setMoveTime(long long milliseconds) {
+        setTimeLimit(int(max(1LL, milliseconds - MOVE_OVERHEAD_MS)));
+        fixedMoveTime = true;
+    }
+    void setUseNnue(bool enabled) {
+        if (enabled) nnueNetwork();
+        useNnue = enabled;
+    }
+    
+    // Mode UCI: waktu dialokasikan dari clock, atau tanpa batas jika time = 0
+    void setClock(long long time, long long increment, int moves) {
+        clockTime = time;
+        clockIncrement = increment;
+        movesToGo = moves;
+        if (time > 0) useTimeLimit = true;
+    }
+    void setNodeLimit(uint64_t nodes) { nodeLimit = nodes; }
+    void setInfinite(bool infinite) { infiniteSearch = infinite; }
+    void setUciOutput(bool enabled) { uciOutput = enabled; }
+    void setHashSize(int megabytes) { tt.resize(megabytes); }
+    
+    // Lupakan semua informasi dari game sebelumnya
+    void newGame() {
+        tt.clear();
+        for (SearchThread& td : threads) td.clearOrderingTables();
+    }
+    
+    uint64_t getLastSearchNodes() const { return lastSearchStats.nodes; }
+    const SearchStats& getLastSearchStats() const { return lastSearchStats; }
+    
+    // Tujuan baris JSON statistik (nullptr mematikan); stream harus hidup selama engine dipakai
+    void setStatsOutput(ostream* out) { statsOut = out; }
+    long long getLastSearchTime() const { return lastSearchTime; }
+    int getLastCompletedDepth() const { return lastCompletedDepth; }
+    
+    // Gravity: entry mendekati ±HISTORY_MAX makin lambat berubah
+    static void updateHistory(int& entry, int bonus) {
+        entry += bonus - entry * abs(bonus) / HISTORY_MAX;
     }
     
-    int evaluateBoard(const ChessBoard& board) {
-        if (board.isCheckmate()) {
-            return (board.getCurrentPlayer() == WHITE) ? -9999 : 9999;
+    void recordCutoff(SearchThread& td, Move move, Move lastMove, int depth, int ply,
+                      int movesSearched, const Move* quietsTried, int quietCount) {
+        td.stats.betaCutoffs++;
+        if (movesSearched == 1) td.stats.firstMoveCutoffs++;
+        if (useOrderingHeuristics && !move.isCapture() && !move.isPromotion()) {
+            updateQuietStats(td, move, lastMove, depth, ply, quietsTried, quietCount);
         }
+    }
+    
+    // Dipanggil saat quiet move menyebabkan cutoff
+    void updateQuietStats(SearchThread& td, Move move, Move lastMove, int depth, int ply,
+                          const Move* quietsTried, int quietCount) {
+        Color us = td.board.getCurrentPlayer();
+        if (ply < MAX_PLY && td.killers[ply][0] != move) {
+            td.killers[ply][1] = td.killers[ply][0];
+            td.killers[ply][0] = move;
+        }
+        if (lastMove.isValid()) td.counterMoves[us][lastMove.from()][lastMove.to()] = move;
         
-        if (board.isStalemate()) {
-            return 0;
+        int bonus = min(16 * depth * depth, 1200);
+        updateHistory(td.historyTable[us][move.from()][move.to()], bonus);
+        for (int i = 0; i < quietCount; i++) {
+            if (quietsTried[i] != move) {
+                updateHistory(td.historyTable[us][quietsTried[i].from()][quietsTried[i].to()], -bonus);
+            }
         }
+    }
+    
+    // Bound ditentukan dari window awal node (score perspektif side to move)
+    void storeResult(uint64_t key, Move bestMove, int score, int depth,
+                     int alphaOrig, int betaOrig, int currentDepth) {
+        if (searchStopped.load(memory_order_relaxed)) return;
         
-        int score = 0;
-        int materialScore = 0;
-        int mobilityScore = 0;
+        Bound bound = BOUND_EXACT;
+        if (score <= alphaOrig) bound = BOUND_UPPER;
+        else if (score >= betaOrig) bound = BOUND_LOWER;
         
-        // Material evaluation dari perspektif WHITE
-        for (int square = 0; square < 64; square++) {
-            Piece piece = board.getPiece(square);
-            if (!piece.isEmpty()) {
-                int value = pieceValues[piece.type];
-                if (piece.color == WHITE) {
-                    materialScore += value;
-                } else {
-                    materialScore -= value;
+        tt.store(key, bestMove, scoreToTT(score, currentDepth), depth, bound);
+    }
+    
+    steady_clock::time_point searchStart() const {
+        return steady_clock::time_point(steady_clock::duration(startTicks.load(memory_order_relaxed)));
+    }
+    
+    long long elapsedMs() const {
+        return duration_cast<milliseconds>(steady_clock::now() - searchStart()).count();
+    }
+    
+    // Hanya thread utama yang membaca jam, dan hanya setiap TIME_CHECK_INTERVAL node
+    void pollTime(const SearchThread& td) {
+        if (!td.isMain() || ((td.stats.nodes + td.stats.qNodes) & (TIME_CHECK_INTERVAL - 1))) return;
+        if (nodeLimit && td.stats.nodes + td.stats.qNodes >= nodeLimit) searchStopped = true;
+        if (!useTimeLimit || pondering.load(memory_order_acquire)) return;
+        if (elapsedMs() >= hardLimit) searchStopped = true;
+    }
+    
+    // Soft limit sebagian dari budget per move; iterasi yang sedang berjalan boleh melewatinya.
+    // Dengan clock (UCI), budget = sisa waktu dibagi sisa move + sebagian besar increment,
+    // dan hard limit tidak pernah lebih dari separuh sisa waktu
+    void allocateTime() {
+        if (clockTime > 0) {
+            long long budget = clockTime / (movesToGo > 0 ? movesToGo : 30) + clockIncrement * 3 / 4;
+            hardLimit = max(1LL, min(budget * 3, clockTime / 2) - MOVE_OVERHEAD_MS);
+            softLimit = min(budget * 3 / 5, hardLimit);
+            return;
+        }
+        hardLimit = timeLimit;
+        softLimit = fixedMoveTime ? hardLimit : timeLimit * 2 / 5;
+    }
+    
+    // Evaluasi di dalam search; waktunya masuk td.stats jika statistik JSON aktif
+    int searchEval(SearchThread& td) {
+        ScopedTimer timer(statsOut ? &td.stats.evalNs : nullptr);
+        return evaluateBoard(td.board, &td.pawnTable);
+    }
+    
+    // Quiescence: hanya capture/promosi (semua evasion jika skak) sampai posisi tenang
+    int quiescence(SearchThread& td, int alpha, int beta, int ply) {
+        ChessBoard& board = td.board;
+        td.stats.qNodes++;
+        pollTime(td);
+        
+        bool inCheck = board.isInCheck(board.getCurrentPlayer());
+        if (searchStopped.load(memory_order_relaxed) || ply >= MAX_PLY - 1) return searchEval(td);
+        
+        // Stand pat: side to move boleh menolak semua capture (tidak berlaku saat skak)
+        int standPat = 0;
+        if (!inCheck) {
+            standPat = searchEval(td);
+            if (standPat >= beta) return standPat;
+            // Delta pruning: bahkan memakan queen tidak cukup untuk mencapai alpha
+            if (standPat + seeValues[QUEEN] + DELTA_MARGIN < alpha) {
+                td.stats.deltaPrunes++;
+                return standPat;
+            }
+            alpha = max(alpha, standPat);
+        }
+        
+        // Capture dengan SEE < 0 tidak pernah dihasilkan picker quiescence
+        MovePicker picker = inCheck ? MovePicker(board, Move(), nullptr) : MovePicker(board);
+        if (statsOut) picker.setProfile(&td.stats);
+        int best = inCheck ? -INFINITE_SCORE : standPat;
+        int movesSearched = 0;
+        Move move;
+        
+        while ((move = picker.next()).isValid()) {
+            movesSearched++;
+            if (!inCheck) {
+                // Delta pruning per move: material yang didapat + margin tetap di bawah alpha
+                int gain = seeValues[board.capturedType(move)] + DELTA_MARGIN;
+                if (move.isPromotion()) gain += seeValues[move.promotion()] - seeValues[PAWN];
+                if (standPat + gain <= alpha) {
+                    td.stats.deltaPrunes++;
+                    continue;
+                }
+            }
+            
+            board.makeMove(move);
+            int score = -quiescence(td, -beta, -alpha, ply + 1);
+            board.unmakeMove();
+            
+            best = max(best, score);
+            alpha = max(alpha, score);
+            if (alpha >= beta) break;
+        }
+        
+        if (inCheck && movesSearched == 0) return terminalScore(board, ply);
+        return best;
+    }
+    
+    // Negamax PVS: score selalu dari perspektif side to move. Move pertama dicari
+    // dengan window penuh, sisanya dengan null window dan di-search ulang hanya
+    // jika hasilnya jatuh di dalam (alpha, beta)
+    // Trace adalah policy compile-time (NoTrace / RecordTrace), lihat SearchTrace
+    template<typename Trace>
+    pair<int, Move> negamax(SearchThread& td, int depth, int alpha, int beta,
+                            int currentDepth = 0, Move lastMove = Move()) {
+        ChessBoard& board = td.board;
+        td.stats.nodes++;
+        pollTime(td);
+        Color us = board.getCurrentPlayer();
+        bool pvNode = beta - alpha > 1;
+        bool inCheck = board.isInCheck(us);
+        
+        if constexpr (Trace::enabled) {
+            traceNode(TRACE_ENTER, currentDepth, depth, lastMove, 0, alpha, beta, us);
+        }
+        
+        // Repetisi di dalam search (cukup sekali) atau aturan 50 langkah = draw
+        if (currentDepth > 0 && board.isDrawByRule()) {
+            if constexpr (Trace::enabled) {
+                traceNode(TRACE_DRAW, currentDepth, depth, Move(), 0, alpha, beta, us);
+            }
+            return {0, Move()};
+        }
+        
+        // Stop dari thread lain, hard limit atau perintah stop
+        if (searchStopped.load(memory_order_relaxed)) {
+            int score = searchEval(td);
+            if constexpr (Trace::enabled) {
+                traceNode(TRACE_STOPPED, currentDepth, depth, Move(), score, alpha, beta, us);
+            }
+            return {score, Move()};
+        }
+        
+        // Probe TT: cutoff hanya di node non-PV supaya PV tetap utuh,
+        // selain itu pakai hash move untuk ordering
+        int alphaOrig = alpha, betaOrig = beta;
+        uint64_t key = board.getHashKey();
+        Move hashMove;
+        TTData ttData;
+        td.stats.ttProbes++;
+        if (tt.probe(key, ttData)) {
+            td.stats.ttHits++;
+            hashMove = ttData.move;
+            int ttScore = scoreFromTT(ttData.score, currentDepth);
+            if (!pvNode && currentDepth > 0 && ttData.depth >= depth &&
+                (ttData.bound == BOUND_EXACT ||
+                 (ttData.bound == BOUND_LOWER && ttScore >= beta) ||
+                 (ttData.bound == BOUND_UPPER && ttScore <= alpha))) {
+                td.stats.ttCutoffs++;
+                if constexpr (Trace::enabled) {
+                    traceNode(TRACE_TT_CUTOFF, currentDepth, depth, hashMove, ttScore, alpha, beta, us);
                 }
+                return {ttScore, hashMove};
             }
         }
         
-        // Mobility bonus dari perspektif current player
-        vector<Move> legalMoves = board.generateLegalMoves();
-        mobilityScore = legalMoves.size() * 2;
-        
-        score = materialScore + mobilityScore;
-        
-        // Kembalikan score dari perspektif current player
-        if (board.getCurrentPlayer() == BLACK) {
-            score = -score;
+        if (depth == 0) {
+            int score = quiescence(td, alpha, beta, currentDepth);
+            if constexpr (Trace::enabled) {
+                traceNode(TRACE_LEAF, currentDepth, depth, Move(), score, alpha, beta, us);
+            }
+            return {score, Move()};
         }
         
-        return score;
-    }
-    
-    pair<int, Move> minimax(ChessBoard& board, int depth, int alpha, int beta, 
-                           bool isMaximizing, int currentDepth = 0, Move lastMove = Move()) {
-        nodesSearched++;
+        // Static eval hanya dibutuhkan untuk pruning di node non-PV yang tidak skak
+        bool canPrune = !pvNode && !inCheck && currentDepth > 0;
+        int staticEval = canPrune ? searchEval(td) : 0;
         
-        // Print tree node if enabled
-        if (showTree && currentDepth > 0) {
-            printTreeNode(currentDepth, lastMove, evaluateBoard(board), 
-                         isMaximizing, alpha, beta);
+        // Reverse futility (static null move): eval jauh di atas beta dekat leaf
+        if (canPrune && depth <= 3 && abs(beta) < MATE_BOUND &&
+            staticEval - reverseFutilityMargin * depth >= beta) {
+            td.stats.reverseFutilityPrunes++;
+            if constexpr (Trace::enabled) {
+                traceNode(TRACE_RFP_CUTOFF, currentDepth, depth, Move(), staticEval, alpha, beta, us);
+            }
+            return {staticEval, Move()};
         }
         
-        // Time check (only if time limit is enabled)
-        if (useTimeLimit) {
-            auto now = steady_clock::now();
-            if (duration_cast<milliseconds>(now - startTime).count() > timeLimit) {
-                int score = evaluateBoard(board);
-                if (showTree) {
-                    printTreeNode(currentDepth, lastMove, score, isMaximizing, 
-                                 alpha, beta, "TIME_CUTOFF");
+        // Null-move pruning: jika melewatkan giliran pun tetap >= beta, node ini hampir
+        // pasti fail-high. Tidak dipakai saat skak, dua kali berturut-turut, atau saat
+        // side to move hanya punya pawn (zugzwang)
+        if (canPrune && depth >= 3 && lastMove.isValid() &&
+            board.hasNonPawnMaterial(us) && currentDepth < MAX_PLY - 1) {
+            if (staticEval >= beta && board.makeNullMove()) {
+                int reduction = 3 + depth / 6 + min((staticEval - beta) / 200, 3);
+                int score = -negamax<Trace>(td, max(depth - 1 - reduction, 0), -beta, -beta + 1,
+                                            currentDepth + 1, Move()).first;
+                board.unmakeNullMove();
+                
+                if (searchStopped.load(memory_order_relaxed)) {
+                    if constexpr (Trace::enabled) {
+                        traceNode(TRACE_STOPPED, currentDepth, depth, Move(), score, alpha, beta, us);
+                    }
+                    return {score, Move()};
+                }
+                if (score >= beta) {
+                    td.stats.nullMoveCutoffs++;
+                    if constexpr (Trace::enabled) {
+                        traceNode(TRACE_NULL_CUTOFF, currentDepth, depth, Move(), score, alpha, beta, us);
+                    }
+                    // Mate dari null move tidak bisa dipercaya
+                    return {score >= MATE_BOUND ? beta : score, Move()};
                 }
-                return {score, Move()};
             }
         }
         
-        if (depth == 0 || board.isGameOver()) {
-            int score = evaluateBoard(board);
-            if (showTree) {
-                string nodeType = (depth == 0) ? "LEAF" : "TERMINAL";
-                printTreeNode(currentDepth, lastMove, score, isMaximizing, 
-                             alpha, beta, nodeType);
+        Move bestMove;
+        bool ordering = useOrderingHeuristics && currentDepth < MAX_PLY;
+        MovePicker picker(board, hashMove, ordering ? td.killers[currentDepth] : nullptr,
+                          ordering && lastMove.isValid() ? td.counterMoves[us][lastMove.from()][lastMove.to()] : Move(),
+                          ordering ? td.historyTable[us] : nullptr);
+        if (statsOut) picker.setProfile(&td.stats);
+        int bestScore = -INFINITE_SCORE;
+        int movesSearched = 0;
+        Move move;
+        Move quietsTried[MAX_MOVES];
+        int quietCount = 0;
+        
+        // Futility dan late move pruning untuk quiet move di depth 1-3
+        bool frontier = canPrune && depth <= 3;
+        bool futile = frontier && staticEval + futilityMargin * depth <= alpha;
+        int lmpLimit = lmpBase + depth * depth;
+        
+        while ((move = picker.next()).isValid()) {
+            movesSearched++;
+            bool quiet = !move.isCapture() && !move.isPromotion();
+            board.makeMove(move);
+            
+            // Minimal satu move sudah dicari dan tidak kalah mate, jadi bestScore tetap valid;
+            // move yang memberi skak tidak pernah dipangkas
+            if (frontier && quiet && bestScore > -MATE_BOUND && !board.isInCheck(board.getCurrentPlayer())) {
+                if (futile) {
+                    board.unmakeMove();
+                    td.stats.futilityPrunes++;
+                    continue;
+                }
+                if (quietCount >= lmpLimit) {
+                    board.unmakeMove();
+                    td.stats.lateMovePrunes++;
+                    continue;
+                }
             }
-            return {score, Move()};
+            
+            int score;
+            if (movesSearched == 1) {
+                score = -negamax<Trace>(td, depth - 1, -beta, -alpha, currentDepth + 1, move).first;
+            } else {
+                // Late move reduction: quiet move yang diurutkan belakang dicari lebih dangkal
+                int reduction = 0;
+                if (depth >= 3 && quiet && !inCheck && !board.isInCheck(board.getCurrentPlayer())) {
+                    reduction = lmrTable[min(depth, 63)][min(movesSearched, 63)];
+                    if (pvNode) reduction--;
+                    if (ordering && (move == td.killers[currentDepth][0] || move == td.killers[currentDepth][1])) reduction--;
+                    reduction = max(0, min(reduction, depth - 2));
+                    if (reduction > 0) td.stats.lmrReductions++;
+                }
+                
+                score = -negamax<Trace>(td, depth - 1 - reduction, -alpha - 1, -alpha, currentDepth + 1, move).first;
+                if (reduction > 0 && score > alpha) {
+                    td.stats.lmrResearches++;
+                    score = -negamax<Trace>(td, depth - 1, -alpha - 1, -alpha, currentDepth + 1, move).first;
+                }
+                if (score > alpha && score < beta) {
+                    td.stats.pvsResearches++;
+                    score = -negamax<Trace>(td, depth - 1, -beta, -alpha, currentDepth + 1, move).first;
+                }
+            }
+            board.unmakeMove();
+            
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = move;
+            }
+            
+            alpha = max(alpha, score);
+            
+            if (alpha >= beta) {
+                recordCutoff(td, move, lastMove, depth, currentDepth, movesSearched, quietsTried, quietCount);
+                break; // Alpha-beta pruning
+            }
+            if (quiet) quietsTried[quietCount++] = move;
         }
         
-        Move bestMove;
-        vector<Move> legalMoves = board.generateLegalMoves();
+        if (movesSearched == 0) bestScore = terminalScore(board, currentDepth);
+        storeResult(key, bestMove, bestScore, depth, alphaOrig, betaOrig, currentDepth);
+        if constexpr (Trace::enabled) {
+            TraceEvent event = (movesSearched == 0) ? TRACE_NO_MOVES :
+                               (bestScore >= betaOrig) ? TRACE_CUT :
+                               (bestScore > alphaOrig) ? TRACE_PV : TRACE_ALL;
+            traceNode(event, currentDepth, depth, bestMove, bestScore, alphaOrig, betaOrig, us);
+        }
+        return {bestScore, bestMove};
+    }
+    
+    // Iterative deepening satu thread. Helper dengan id ganjil mulai satu ply lebih
+    // dalam supaya thread tidak mencari depth yang sama secara serempak; hasil yang
+    // dipakai hanya dari thread utama
+    void iterativeDeepening(SearchThread& td) {
+        ChessBoard& board = td.board;
+        int previousScore = 0; // perspektif side to move, pusat aspiration window
         
-        // Move ordering: captures first
-        sort(legalMoves.begin(), legalMoves.end(), [&](const Move& a, const Move& b) {
-            return a.isCapture > b.isCapture;
-        });
+        // Untuk time management thread utama
+        MoveList rootMoves;
+        board.generateLegalMoves(rootMoves);
+        int stableIterations = 0;
+        uint64_t iterationNodesHistory[2] = {0, 0}; // dua iterasi sebelumnya
+        uint64_t previousIterationNodes = 0;        // untuk effective branching factor
+        bool tracing = SearchTrace::enabled && showTree && !quietSearch && td.isMain();
         
-        if (isMaximizing) {
-            int maxEval = INT_MIN;
-            for (size_t i = 0; i < legalMoves.size(); i++) {
-                const Move& move = legalMoves[i];
-                ChessBoard newBoard = board;
-                newBoard.makeMove(move);
-                
-                // Recursive call dengan isMaximizing diflip
-                auto [eval, _] = minimax(newBoard, depth - 1, alpha, beta, false, 
-                                       currentDepth + 1, move);
+        for (int depth = 1 + (td.id & 1); depth <= maxDepth; depth++) {
+            auto start = steady_clock::now();
+            SearchStats statsBefore = td.stats;
+            
+            if constexpr (SearchTrace::enabled) {
+                if (tracing) traceNode(TRACE_ITERATION, 0, depth, Move(), 0, 0, 0, board.getCurrentPlayer());
+            }
+            
+            uint64_t allocationsBefore = heapAllocationCount.load(memory_order_relaxed);
+            
+            // Aspiration window di sekitar score iterasi sebelumnya; diperlebar saat fail
+            int delta = ASPIRATION_DELTA;
+            int alpha = -INFINITE_SCORE, beta = INFINITE_SCORE;
+            if (depth >= 4) {
+                alpha = max(previousScore - delta, -INFINITE_SCORE);
+                beta = min(previousScore + delta, INFINITE_SCORE);
+            }
+            
+            pair<int, Move> result;
+            while (true) {
+                // Hanya thread utama yang di-trace
+                result = tracing ? negamax<SearchTrace>(td, depth, alpha, beta) : negamax<NoTrace>(td, depth, alpha, beta);
+                if (searchStopped) break;
                 
-                if (eval > maxEval) {
-                    maxEval = eval;
-                    bestMove = move;
+                if (result.first <= alpha) {
+                    beta = (alpha + beta) / 2;
+                    alpha = max(result.first - delta, -INFINITE_SCORE);
+                } else if (result.first >= beta) {
+                    beta = min(result.first + delta, INFINITE_SCORE);
+                } else {
+                    break;
+                }
+                td.stats.aspirationResearches++;
+                delta += delta / 2;
+            }
+            auto [score, move] = result;
+            if (!searchStopped) {
+                previousScore = score;
+                td.completedDepth = depth;
+            }
+            if (!td.isMain()) {
+                if (searchStopped) break;
+                continue;
+            }
+            
+            int whiteScore = (board.getCurrentPlayer() == WHITE) ? score : -score;
+            uint64_t searchAllocations = heapAllocationCount.load(memory_order_relaxed) - allocationsBefore;
+            
+            auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
+            SearchStats iteration = td.stats - statsBefore;
+            uint64_t currentDepthNodes = iteration.nodes;
+            uint64_t iterationNodes = iteration.nodes + iteration.qNodes;
+            
+            // Iterasi yang terpotong stop tidak bisa dipercaya (node setelah stop hanya
+            // mengembalikan static eval), jadi hasil iterasi terakhir yang selesai dipertahankan
+            if (move.isValid() && !searchStopped) {
+                stableIterations = (move == td.bestMove) ? stableIterations + 1 : 0;
+                td.bestMove = move;
+                td.bestScore = whiteScore;
+                if (uciOutput) printUciInfo(td, depth, score, move);
+                if (statsOut) {
+                    writeIterationStats(depth, score, move, iteration,
+                                        duration_cast<microseconds>(steady_clock::now() - start).count(),
+                                        previousIterationNodes);
                 }
                 
-                alpha = max(alpha, eval);
-                
-                if (beta <= alpha) {
-                    if (showTree) {
-                        printTreeNode(currentDepth + 1, move, eval, false, 
-                                     alpha, beta, "BETA_CUTOFF");
+                if (!quietSearch) {
+                    cout << "\n📊 DEPTH " << depth << " SELESAI:" << endl;
+                    cout << "• Gerakan terbaik: " << move.toString() << endl;
+                    cout << "• Score: " << whiteScore << endl;
+                    cout << "• Nodes: " << currentDepthNodes << " (Total: " << td.stats.nodes << ")"
+                         << (threadCount > 1 ? " [thread utama]" : "") << endl;
+                    cout << "• QNodes: " << iteration.qNodes << " (Total: " << td.stats.qNodes << ")" << endl;
+                    cout << "• Waktu: " << elapsed.count() << " ms" << endl;
+                    cout << "• NPS: " << (elapsed.count() > 0 ? (currentDepthNodes * 1000 / elapsed.count()) : 0) << " nodes/s" << endl;
+                    cout << "• TT hits: " << td.stats.ttHits << "/" << td.stats.ttProbes << " (hashfull " << tt.hashfull() << "‰)" << endl;
+                    cout << "• Pawn hash hits: " << td.pawnTable.getHits() << "/" << td.pawnTable.getProbes() << " ("
+                         << fixed << setprecision(1)
+                         << (td.pawnTable.getProbes() ? 100.0 * td.pawnTable.getHits() / td.pawnTable.getProbes() : 0.0)
+                         << "%)" << defaultfloat << endl;
+                    cout << "• Cutoff: " << td.stats.betaCutoffs << " (move pertama "
+                         << fixed << setprecision(1) << (td.stats.betaCutoffs ? 100.0 * td.stats.firstMoveCutoffs / td.stats.betaCutoffs : 0.0) << "%)"
+                         << defaultfloat << (useOrderingHeuristics ? "" : " [killer/history non-aktif]") << endl;
+                    cout << "• Re-search: PVS " << td.stats.pvsResearches << ", aspiration " << td.stats.aspirationResearches
+                         << ", LMR " << td.stats.lmrResearches << "/" << td.stats.lmrReductions << endl;
+                    cout << "• Null-move cutoff: " << td.stats.nullMoveCutoffs << endl;
+                    cout << "• Pruning: futility " << td.stats.futilityPrunes << ", reverse futility " << td.stats.reverseFutilityPrunes
+                         << ", LMP " << td.stats.lateMovePrunes << endl;
+                    if (statsOut) {
+                        cout << "• Waktu movegen/eval: " << fixed << setprecision(1) << iteration.movegenNs / 1e6
+                             << "/" << iteration.evalNs / 1e6 << " ms" << defaultfloat << endl;
                     }
-                    break; // Alpha-beta pruning
+                    cout << "• Heap alloc: " << searchAllocations << endl;
+                    
+                    // Evaluasi kualitas gerakan dari sisi engine
+                    if (score > 500) cout << "• Status: 🟢 Sangat menguntungkan!" << endl;
+                    else if (score > 100) cout << "• Status: 🔵 Menguntungkan" << endl;
+                    else if (score > -100) cout << "• Status: 🟡 Seimbang" << endl;
+                    else if (score > -500) cout << "• Status: 🟠 Kurang menguntungkan" << endl;
+                    else cout << "• Status: 🔴 Berbahaya!" << endl;
                 }
             }
-            return {maxEval, bestMove};
-        } else {
-            int minEval = INT_MAX;
-            for (size_t i = 0; i < legalMoves.size(); i++) {
-                const Move& move = legalMoves[i];
-                ChessBoard newBoard = board;
-                newBoard.makeMove(move);
-                
-                // Recursive call dengan isMaximizing diflip
-                auto [eval, _] = minimax(newBoard, depth - 1, alpha, beta, true, 
-                                       currentDepth + 1, move);
+            
+            if (!searchStopped) previousIterationNodes = iterationNodes;
+            if (searchStopped) {
+                if (!quietSearch) cout << "⏰ Search dihentikan, iterasi depth " << depth << " dibatalkan" << endl;
+                break;
+            }
+            
+            // Iterasi berikutnya hanya dimulai jika masih berguna: best move yang stabil
+            // memperpendek soft limit, dan iterasi yang diperkirakan (dari branching factor
+            // iterasi terakhir) tidak selesai sebelum hard limit tidak dimulai sama sekali.
+            // Selama ponder tidak ada batas waktu sampai ponder hit; go movetime selalu memakai
+            // seluruh waktu sampai hard limit
+            // Rasio node per iterasi naik-turun antara depth ganjil/genap, jadi branching
+            // factor diambil dari rata-rata geometris dua iterasi terakhir
+            double branching = iterationNodesHistory[0] ?
+                sqrt(double(iterationNodes) / iterationNodesHistory[0]) : 4.0;
+            branching = min(max(branching, 1.5), 8.0);
+            iterationNodesHistory[0] = iterationNodesHistory[1];
+            iterationNodesHistory[1] = iterationNodes;
+            
+            // Juga dipakai saat ponder hit untuk memutuskan apakah iterasi berikutnya ditunggu
+            double iterationMs = duration<double, milli>(steady_clock::now() - start).count();
+            auto iterationEnd = steady_clock::now() + duration_cast<steady_clock::duration>(
+                duration<double, milli>(iterationMs * branching));
+            iterationEndTicks.store(iterationEnd.time_since_epoch().count(), memory_order_relaxed);
+            
+            if (useTimeLimit && !pondering.load(memory_order_acquire)) {
+                static const double stabilityScale[5] = {2.0, 1.5, 1.2, 1.0, 0.75};
+                long long now = elapsedMs();
+                long long predictedEnd = now + (long long)(iterationMs * branching);
                 
-                if (eval < minEval) {
-                    minEval = eval;
-                    bestMove = move;
+                if (rootMoves.size() == 1) {
+                    if (!quietSearch) cout << "⏰ Hanya satu gerakan legal, menghentikan pencarian..." << endl;
+                    break;
                 }
-                
-                beta = min(beta, eval);
-                
-                if (beta <= alpha) {
-                    if (showTree) {
-                        printTreeNode(currentDepth + 1, move, eval, true, 
-                                     alpha, beta, "ALPHA_CUTOFF");
-                    }
-                    break; // Alpha-beta pruning
+                if (fixedMoveTime) continue;
+                if (now >= softLimit * stabilityScale[min(stableIterations, 4)]) {
+                    if (!quietSearch) cout << "⏰ Soft limit tercapai (best move stabil " << stableIterations
+                         << " iterasi), menghentikan pencarian..." << endl;
+                    break;
+                }
+                if (predictedEnd > hardLimit) {
+                    if (!quietSearch) cout << "⏰ Depth " << (depth + 1) << " diperkirakan selesai di " << predictedEnd
+                         << " ms (branching " << fixed << setprecision(1) << branching << defaultfloat
+                         << "), melewati hard limit; menghentikan pencarian..." << endl;
+                    break;
                 }
             }
-            return {minEval, bestMove};
         }
     }
     
-    Move getBestMove(ChessBoard& board) {
-        startTime = steady_clock::now();
-        nodesSearched = 0;
+    // Mulai search di thread worker dan langsung kembali; hasil diambil dengan waitSearch
+    void startSearch(const ChessBoard& board, bool quiet = false) {
+        if (searchWorker.joinable()) searchWorker.join();
+        
+        startTicks.store(steady_clock::now().time_since_epoch().count(), memory_order_relaxed);
+        searchStopped = false;
+        iterationEndTicks.store(0, memory_order_relaxed);
+        quietSearch = quiet;
+        allocateTime();
+        tt.newSearch();
+        for (SearchThread& td : threads) {
+            td.board = board;
+            td.board.setNnueIncremental(useNnue);
+            td.resetStats();
+            td.ageOrderingTables();
+        }
+        
+        if (quiet) {
+            searchWorker = thread(&ChessEngine::runSearch, this);
+            return;
+        }
         
         cout << "\n🤖 ENGINE BERPIKIR..." << endl;
         cout << "═══════════════════════" << endl;
         cout << "Kedalaman maksimal: " << maxDepth << endl;
-        cout << "Batas waktu: " << (useTimeLimit ? to_string(timeLimit) + " ms" : "Tidak terbatas") << endl;
+        cout << "Batas waktu: " << (useTimeLimit ? "soft " + to_string(softLimit) + " ms, hard " + to_string(hardLimit) + " ms"
+                                                 : string("Tidak terbatas")) << endl;
+        cout << "Thread: " << threadCount << endl;
         cout << "Tampilkan tree: " << (showTree ? "Ya" : "Tidak") << endl;
         cout << "═══════════════════════" << endl;
         
-        Move bestMove;
-        int bestScore = (board.getCurrentPlayer() == WHITE) ? INT_MIN : INT_MAX;
+        if (SearchTrace::enabled && showTree) traceBuffer.clear();
         
-        if (showTree) {
-            cout << "\n🌳 SEARCH TREE:" << endl;
-            cout << "ROOT - Giliran: " << (board.getCurrentPlayer() == WHITE ? "WHITE" : "BLACK") << endl;
-        }
+        searchWorker = thread(&ChessEngine::runSearch, this);
+    }
+    
+    // Aman dipanggil dari thread lain; search berhenti di poll node berikutnya
+    void stopSearch() { searchStopped = true; }
+    
+    // Tunggu search yang sedang berjalan tanpa mencetak ringkasan (mode UCI)
+    void waitSearchQuietly() {
+        if (searchWorker.joinable()) searchWorker.join();
+    }
+    
+    Move waitSearch() {
+        if (searchWorker.joinable()) searchWorker.join();
         
-        // Iterative deepening
-        for (int depth = 1; depth <= maxDepth; depth++) {
-            auto start = steady_clock::now();
-            int prevNodesSearched = nodesSearched;
-            nodesSearched = 0;
-            
-            if (showTree) {
-                cout << "\n--- DEPTH " << depth << " ---" << endl;
-            }
-            
-            auto [score, move] = minimax(board, depth, INT_MIN, INT_MAX, 
-                                       board.getCurrentPlayer() == WHITE);
-            
-            auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start);
-            int currentDepthNodes = nodesSearched;
-            nodesSearched += prevNodesSearched;
-            
-            if (move.isValid()) {
-                bestMove = move;
-                bestScore = score;
-                
-                cout << "\n📊 DEPTH " << depth << " SELESAI:" << endl;
-                cout << "• Gerakan terbaik: " << move.toString() << endl;
-                cout << "• Score: " << score << endl;
-                cout << "• Nodes: " << currentDepthNodes << " (Total: " << nodesSearched << ")" << endl;
-                cout << "• Waktu: " << elapsed.count() << " ms" << endl;
-                cout << "• NPS: " << (elapsed.count() > 0 ? (currentDepthNodes * 1000 / elapsed.count()) : 0) << " nodes/s" << endl;
-                
-                // Evaluasi kualitas gerakan
-                if (score > 500) cout << "• Status: 🟢 Sangat menguntungkan!" << endl;
-                else if (score > 100) cout << "• Status: 🔵 Menguntungkan" << endl;
-                else if (score > -100) cout << "• Status: 🟡 Seimbang" << endl;
-                else if (score > -500) cout << "• Status: 🟠 Kurang menguntungkan" << endl;
-                else cout << "• Status: 🔴 Berbahaya!" << endl;
-            }
-            
-            // Break if we're running out of time (only if time limit is enabled)
-            if (useTimeLimit && elapsed.count() > timeLimit * 0.8) {
-                cout << "⏰ Batas waktu hampir habis, menghentikan pencarian..." << endl;
-                break;
+        if (SearchTrace::enabled && showTree && !quietSearch) {
+            if (traceBuffer.save(TRACE_FILE)) {
+                cout << "\n🌳 Trace " << traceBuffer.getTotal() << " record disimpan ke " << TRACE_FILE
+                     << "; render dengan --render-trace " << TRACE_FILE << " [text|dot]" << endl;
+            } else {
+                cout << "❌ Gagal menyimpan trace ke " << TRACE_FILE << endl;
             }
         }
         
-        auto totalTime = duration_cast<milliseconds>(steady_clock::now() - startTime);
+        const SearchThread& main = threads[0];
+        uint64_t totalNodes = lastSearchStats.nodes;
         
         cout << "\n🏁 PENCARIAN SELESAI:" << endl;
         cout << "═══════════════════════" << endl;
-        cout << "• Total waktu: " << totalTime.count() << " ms" << endl;
-        cout << "• Total nodes: " << nodesSearched << endl;
-        cout << "• Average NPS: " << (totalTime.count() > 0 ? (nodesSearched * 1000 / totalTime.count()) : 0) << " nodes/s" << endl;
-        cout << "• Kedalaman tercapai: " << maxDepth << endl;
-        cout << "• Evaluasi akhir: " << bestScore << endl;
+        cout << "• Total waktu: " << lastSearchTime << " ms" << endl;
+        cout << "• Total nodes: " << totalNodes << (threadCount > 1 ? " (" + to_string(threadCount) + " thread)" : "") << endl;
+        cout << "• Total qnodes: " << lastSearchStats.qNodes << endl;
+        cout << "• Average NPS: " << (lastSearchTime > 0 ? (totalNodes * 1000 / lastSearchTime) : 0) << " nodes/s" << endl;
+        cout << "• Kedalaman tercapai: " << main.completedDepth << endl;
+        cout << "• Evaluasi akhir: " << main.bestScore << endl;
         cout << "═══════════════════════" << endl;
         
-        return bestMove;
+        return main.bestMove;
+    }
+    
+    Move getBestMove(ChessBoard& board) {
+        if (pondering) {
+            if (board.getHashKey() == ponderKey) {
+                // Ponder hit: search yang sama dilanjutkan dengan batas waktu normal yang dimulai
+                // dari sekarang. Jam di-reset sebelum flag ponder dilepas (release, dipasangkan
+                // dengan load acquire di pollTime), jadi batas waktu tidak pernah dihitung dari
+                // waktu mulai ponder
+                cout << "\n🎯 Ponder hit (" << ponderMove.toString() << "), melanjutkan search ponder..." << endl;
+                auto hitTime = steady_clock::now();
+                startTicks.store(hitTime.time_since_epoch().count(), memory_order_relaxed);
+                pondering.store(false, memory_order_release);
+                
+                // Soft limit dihitung dari hit. Jika iterasi yang sedang berjalan diperkirakan tidak
+                // selesai di dalamnya, hasilnya akan dipotong hard limit dan dibuang, jadi iterasi
+                // terdalam yang sudah selesai langsung dipakai
+                steady_clock::rep iterationEnd = iterationEndTicks.load(memory_order_relaxed);
+                long long remaining = duration_cast<milliseconds>(
+                    steady_clock::duration(iterationEnd) - hitTime.time_since_epoch()).count();
+                if (useTimeLimit && iterationEnd != 0 && remaining > softLimit) {
+                    cout << "• Iterasi berjalan diperkirakan butuh " << remaining << " ms lagi (soft limit "
+                         << softLimit << " ms), memakai depth yang sudah selesai" << endl;
+                    stopSearch();
+                }
+                Move move = waitSearch();
+                cout << "• Respon setelah ponder hit: "
+                     << duration_cast<milliseconds>(steady_clock::now() - hitTime).count() << " ms" << endl;
+                return move;
+            }
+            stopPonder();
+        }
+        
+        startSearch(board);
+        return waitSearch();
+    }
+    
+    // Dipanggil setelah engine bergerak: ponder di posisi setelah balasan yang diprediksi
+    // dari TT, atau di posisi sekarang (semua balasan) jika tidak ada prediksi. Hasil
+    // ponder yang tidak cocok tetap berguna lewat TT
+    void startPonder(const ChessBoard& board) {
+        if (!usePonder || board.isGameOver()) return;
+        
+        ChessBoard ponderBoard = board;
+        TTData ttData;
+        ponderMove = Move();
+        if (tt.probe(board.getHashKey(), ttData) && ttData.move.isValid()) {
+            MoveList legalMoves;
+            board.generateLegalMoves(legalMoves);
+            for (const Move& move : legalMoves) {
+                if (move == ttData.move) ponderMove = move;
+            }
+        }
+        if (ponderMove.isValid()) {
+            ponderBoard.makeMove(ponderMove);
+            if (ponderBoard.isGameOver()) {
+                ponderBoard = board;
+                ponderMove = Move();
+            }
+        }
+        
+        ponderKey = ponderBoard.getHashKey();
+        pondering = true;
+        startSearch(ponderBoard, true);
+    }
+    
+    // Ponder miss atau engine perlu dikonfigurasi ulang: hentikan dan buang hasilnya
+    void stopPonder() {
+        if (!pondering) return;
+        stopSearch();
+        if (searchWorker.joinable()) searchWorker.join();
+        pondering = false;
+    }
+    
+    bool isPondering() const { return pondering; }
+    
+    // Isi thread worker: Lazy SMP, helper mencari root yang sama dan hanya berbagi
+    // informasi lewat TT; begitu thread utama selesai, helper dihentikan lewat flag stop
+    void runSearch() {
+        vector<thread> helpers;
+        for (int i = 1; i < threadCount; i++) {
+            helpers.emplace_back(&ChessEngine::iterativeDeepening, this, ref(threads[i]));
+        }
+        iterativeDeepening(threads[0]);
+        while (infiniteSearch && !searchStopped) this_thread::sleep_for(milliseconds(1));
+        searchStopped = true;
+        for (thread& helper : helpers) helper.join();
+        
+        // Search yang dihentikan sebelum depth 1 selesai tetap harus menjawab move legal
+        SearchThread& main = threads[0];
+        if (!main.bestMove.isValid()) {
+            MoveList legalMoves;
+            main.board.generateLegalMoves(legalMoves);
+            if (legalMoves.size() > 0) main.bestMove = legalMoves[0];
+        }
+        
+        lastSearchStats = SearchStats();
+        for (const SearchThread& td : threads) lastSearchStats += td.stats;
+        long long micros = duration_cast<microseconds>(steady_clock::now() - searchStart()).count();
+        lastSearchTime = micros / 1000;
+        lastCompletedDepth = main.completedDepth;
+        if (statsOut) writeSearchStats(micros);
+        
+        if (uciOutput) {
+            cout << "bestmove " << (main.bestMove.isValid() ? main.bestMove.toString() : "0000") << endl;
+        }
+    }
+    
+    // PV dari rantai hash move di TT; berhenti di move yang tidak legal atau repetisi
+    string principalVariation(const ChessBoard& root, Move first, int maxLength) const {
+        ChessBoard board = root;
+        string pv = first.toString();
+        board.makeMove(first);
+        for (int i = 1; i < maxLength && !board.isRepetition(); i++) {
+            TTData ttData;
+            if (!tt.probe(board.getHashKey(), ttData) || !ttData.move.isValid()) break;
+            
+            MoveList legalMoves;
+            board.generateLegalMoves(legalMoves);
+            Move next;
+            for (const Move& move : legalMoves) {
+                if (move == ttData.move) next = move;
+            }
+            if (!next.isValid()) break;
+            
+            pv += " " + next.toString();
+            board.makeMove(next);
+        }
+        return pv;
+    }
+    
+    // Satu baris info UCI per iterasi; score dari perspektif side to move, node thread utama
+    void printUciInfo(const SearchThread& td, int depth, int score, Move move) const {
+        long long elapsed = elapsedMs();
+        uint64_t nodes = td.stats.nodes + td.stats.qNodes;
+        
+        ostringstream line;
+        line << "info depth " << depth << " score ";
+        if (abs(score) >= MATE_BOUND) {
+            int plies = MATE_SCORE - abs(score);
+            line << "mate " << (score > 0 ? (plies + 1) / 2 : -(plies / 2));
+        } else {
+            line << "cp " << score;
+        }
+        line << " nodes " << nodes << " nps " << nodes * 1000 / (elapsed + 1)
+             << " time " << elapsed << " hashfull " << tt.hashfull()
+             << " pv " << principalVariation(td.board, move, depth);
+        cout << line.str() << endl;
+    }
+    
+    // Baris JSON untuk iterasi thread utama yang selesai; ebf = node iterasi ini dibagi
+    // node iterasi sebelumnya (0 di iterasi pertama), score dari perspektif side to move
+    void writeIterationStats(int depth, int score, Move move, const SearchStats& iteration,
+                             long long micros, uint64_t previousNodes) {
+        ostringstream line;
+        line << "{\"type\":\"iteration\",\"depth\":" << depth << ",\"score\":" << score
+             << ",\"bestmove\":\"" << move.toString() << "\",\"ebf\":" << fixed << setprecision(3)
+             << SearchStats::ratio(iteration.nodes + iteration.qNodes, previousNodes) << defaultfloat << ",";
+        iteration.writeJsonFields(line, micros);
+        line << "}";
+        *statsOut << line.str() << endl;
+    }
+    
+    // Baris JSON ringkasan satu search, dijumlah dari semua thread; ponder true berarti
+    // search ponder yang dibuang (ponder miss atau keluar)
+    void writeSearchStats(long long micros) {
+        const SearchThread& main = threads[0];
+        ostringstream line;
+        line << "{\"type\":\"search\",\"fen\":\"" << main.board.getFEN() << "\",\"threads\":" << threadCount
+             << ",\"ponder\":" << (pondering ? "true" : "false") << ",\"depth\":" << main.completedDepth
+             << ",\"bestmove\":\"" << (main.bestMove.isValid() ? main.bestMove.toString() : "0000") << "\",";
+        lastSearchStats.writeJsonFields(line, micros);
+        line << "}";
+        *statsOut << line.str() << endl;
     }
     
     bool isAnalysisEnabled() const {
@@ -1158,9 +4010,451 @@ public:
     }
 };
 
-int main() {
+// Perft / divide: hitung leaf nodes untuk verifikasi move generator dan ukur kecepatannya
+void runPerft(const string& fen, int depth, bool divide) {
+    ChessBoard board;
+    if (!board.setFromFEN(fen)) {
+        cout << "❌ FEN tidak valid: " << fen << endl;
+        return;
+    }
+    
+    auto start = steady_clock::now();
+    uint64_t total = 0;
+    
+    if (divide) {
+        MoveList moves;
+        board.generateLegalMoves(moves);
+        for (const Move& move : moves) {
+            board.makeMove(move);
+            uint64_t nodes = depth > 1 ? board.perft(depth - 1) : 1;
+            board.unmakeMove();
+            cout << move.toString() << ": " << nodes << endl;
+            total += nodes;
+        }
+        cout << "\nGerakan: " << moves.size() << endl;
+    } else {
+        total = board.perft(depth);
+    }
+    
+    auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    cout << "Perft(" << depth << ") = " << total << endl;
+    cout << "Waktu: " << elapsed << " ms, NPS: " << (elapsed > 0 ? total * 1000 / elapsed : 0) << endl;
+}
+
+// Posisi perft standar (chessprogramming wiki) beserta jumlah node yang dipublikasikan
+bool runPerftSuite() {
+    struct PerftPosition {
+        const char* name;
+        const char* fen;
+        int depth;
+        uint64_t expected;
+    };
+    
+    const PerftPosition positions[] = {
+        {"Initial", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609ULL},
+        {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603ULL},
+        {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ULL},
+        {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333ULL},
+        {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487ULL},
+        {"Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL},
+    };
+    
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    auto suiteStart = steady_clock::now();
+    
+    cout << "🧪 PERFT SUITE" << endl;
+    cout << "═══════════════════════" << endl;
+    for (const PerftPosition& pos : positions) {
+        ChessBoard board;
+        board.setFromFEN(pos.fen);
+        
+        auto start = steady_clock::now();
+        uint64_t nodes = board.perft(pos.depth);
+        auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+        
+        bool passed = (nodes == pos.expected);
+        allPassed = allPassed && passed;
+        totalNodes += nodes;
+        
+        cout << (passed ? "✓ " : "❌ ") << setw(10) << left << pos.name << right
+             << " depth " << pos.depth << ": " << nodes;
+        if (!passed) cout << " (expected " << pos.expected << ")";
+        cout << " | " << elapsed << " ms | " << (elapsed > 0 ? nodes * 1000 / elapsed : 0) << " nps" << endl;
+    }
+    
+    auto suiteTime = duration_cast<milliseconds>(steady_clock::now() - suiteStart).count();
+    cout << "═══════════════════════" << endl;
+    cout << "Total: " << totalNodes << " nodes, " << suiteTime << " ms, "
+         << (suiteTime > 0 ? totalNodes * 1000 / suiteTime : 0) << " nps" << endl;
+    cout << (allPassed ? "✓ Semua posisi cocok" : "❌ Ada posisi yang tidak cocok") << endl;
+    return allPassed;
+}
+
+// Posisi benchmark search: pembukaan, middlegame taktis dan endgame
+const char* const BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/2K5/5PPP/8 w - - 0 1",
+};
+
+// Lazy SMP scaling: time-to-depth dan NPS untuk 1, 2, 4, ... sampai maxThreads thread.
+// Setiap run mulai dari TT kosong supaya hasilnya bisa dibandingkan
+void runSmpScaling(int maxThreads, int depth) {
+    vector<int> threadCounts;
+    for (int count = 1; count < maxThreads; count *= 2) threadCounts.push_back(count);
+    threadCounts.push_back(maxThreads);
+    
+    cout << "🧵 LAZY SMP SCALING (depth " << depth << ", core tersedia: " << thread::hardware_concurrency() << ")" << endl;
+    cout << "═══════════════════════════════════════════════════════════" << endl;
+    cout << "Thread |  Waktu (ms) |        Nodes |          NPS | Speedup | NPS x" << endl;
+    cout << "───────────────────────────────────────────────────────────" << endl;
+    
+    double baseTime = 0, baseNps = 0;
+    for (int count : threadCounts) {
+        ChessEngine engine;
+        engine.setThreadCount(count);
+        engine.setMaxDepth(depth);
+        engine.setTimeLimit(0);
+        
+        long long totalTime = 0;
+        uint64_t totalNodes = 0;
+        for (const char* fen : BENCH_POSITIONS) {
+            ChessBoard board;
+            board.setFromFEN(fen);
+            engine.newGame();
+            
+            // Output search per posisi tidak relevan untuk laporan ini
+            streambuf* original = cout.rdbuf(nullptr);
+            engine.getBestMove(board);
+            cout.rdbuf(original);
+            cout.clear();
+            
+            totalTime += engine.getLastSearchTime();
+            totalNodes += engine.getLastSearchNodes();
+        }
+        
+        double nps = totalTime > 0 ? totalNodes * 1000.0 / totalTime : 0;
+        if (count == 1) {
+            baseTime = double(totalTime);
+            baseNps = nps;
+        }
+        cout << setw(6) << count << " | " << setw(11) << totalTime << " | " << setw(12) << totalNodes
+             << " | " << setw(12) << uint64_t(nps) << " | " << fixed << setprecision(2)
+             << setw(7) << (totalTime > 0 ? baseTime / totalTime : 0.0) << " | "
+             << setw(5) << (baseNps > 0 ? nps / baseNps : 0.0) << defaultfloat << endl;
+    }
+    cout << "═══════════════════════════════════════════════════════════" << endl;
+}
+
+// Benchmark search dengan statistik JSON: baris per iterasi dan per posisi dari engine,
+// lalu satu baris total untuk seluruh run (type "bench"). Output dekoratif dibuang
+// supaya stdout bisa langsung diproses sebagai JSON lines
+void runBench(int depth, int threadCount) {
+    ChessEngine engine;
+    engine.setThreadCount(threadCount);
+    engine.setMaxDepth(depth);
+    engine.setTimeLimit(0);
+    
+    streambuf* original = cout.rdbuf(nullptr);
+    ostream jsonOut(original);
+    engine.setStatsOutput(&jsonOut);
+    
+    SearchStats total;
+    long long totalMicros = 0;
+    int positions = 0;
+    for (const char* fen : BENCH_POSITIONS) {
+        ChessBoard board;
+        board.setFromFEN(fen);
+        engine.newGame();
+        
+        auto start = steady_clock::now();
+        engine.getBestMove(board);
+        totalMicros += duration_cast<microseconds>(steady_clock::now() - start).count();
+        total += engine.getLastSearchStats();
+        positions++;
+    }
+    
+    jsonOut << "{\"type\":\"bench\",\"positions\":" << positions << ",\"depth\":" << depth
+            << ",\"threads\":" << threadCount << ",";
+    total.writeJsonFields(jsonOut, totalMicros);
+    jsonOut << "}" << endl;
+    
+    cout.rdbuf(original);
+    cout.clear();
+}
+
+// Render file trace (dari build -DSEARCH_TRACE) menjadi tree teks atau graph DOT. Record
+// ENTER dipasangkan dengan record keluar berikutnya pada level yang sama; jika ring buffer
+// sempat penuh, record keluar tanpa ENTER di awal file diabaikan
+struct TraceNode {
+    TraceRecord enter;
+    TraceRecord exit;
+    bool closed;
+    vector<int> children;
+};
+
+string traceMoveString(uint16_t data, int ply) {
+    Move move;
+    move.data = data;
+    return move.isValid() ? move.toString() : (ply == 0 ? "root" : "null");
+}
+
+int renderTrace(const string& path, const string& format) {
+    ifstream file(path, ios::binary);
+    char magic[8];
+    uint64_t count = 0;
+    if (!file.read(magic, 8) || !equal(magic, magic + 8, TRACE_MAGIC) ||
+        !file.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        cerr << "❌ File trace tidak valid: " << path << endl;
+        return 1;
+    }
+    vector<TraceRecord> records(count);
+    if (!file.read(reinterpret_cast<char*>(records.data()), streamsize(count * sizeof(TraceRecord)))) {
+        cerr << "❌ File trace terpotong: " << path << endl;
+        return 1;
+    }
+    
+    // Bangun tree: root per iterasi, lalu node bersarang sesuai urutan ENTER/keluar
+    vector<TraceNode> nodes;
+    vector<pair<int, int>> iterations; // (depth, index node root)
+    vector<int> stack;
+    for (const TraceRecord& record : records) {
+        if (record.event == TRACE_ITERATION) {
+            stack.clear();
+            iterations.push_back({record.depth, -1});
+        } else if (record.event == TRACE_ENTER) {
+            int index = int(nodes.size());
+            nodes.push_back({record, TraceRecord(), false, {}});
+            if (!stack.empty()) nodes[stack.back()].children.push_back(index);
+            else if (!iterations.empty() && iterations.back().second < 0) iterations.back().second = index;
+            stack.push_back(index);
+        } else if (!stack.empty()) {
+            nodes[stack.back()].exit = record;
+            nodes[stack.back()].closed = true;
+            stack.pop_back();
+        }
+    }
+    
+    auto label = [&](const TraceNode& node) {
+        ostringstream text;
+        text << (node.enter.side == WHITE ? "WHITE" : "BLACK") << " ply=" << int(node.enter.ply)
+             << " depth=" << int(node.enter.depth) << " | " << traceMoveString(node.enter.move, node.enter.ply)
+             << " | α=" << node.enter.alpha << " β=" << node.enter.beta;
+        if (node.closed) {
+            text << " | Score=" << node.exit.score << " [" << traceEventNames[node.exit.event] << "]";
+            if (node.exit.move) text << " best=" << traceMoveString(node.exit.move, 1);
+        } else {
+            text << " [TIDAK SELESAI]";
+        }
+        return text.str();
+    };
+    
+    if (format == "dot") {
+        cout << "digraph search {" << endl;
+        cout << "  node [shape=box, fontname=\"monospace\"];" << endl;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            cout << "  n" << i << " [label=\"" << label(nodes[i]) << "\"];" << endl;
+            for (int child : nodes[i].children) cout << "  n" << i << " -> n" << child << ";" << endl;
+        }
+        cout << "}" << endl;
+        return 0;
+    }
+    
+    // Teks: indentasi seperti tampilan tree lama (├─ untuk node, │ untuk level di atasnya)
+    auto print = [&](auto& self, int index, int level) -> void {
+        string indent;
+        for (int i = 0; i < level; i++) indent += (i == level - 1) ? "├─ " : "│  ";
+        cout << indent << label(nodes[index]) << endl;
+        for (int child : nodes[index].children) self(self, child, level + 1);
+    };
+    cout << "🌳 SEARCH TREE (" << count << " record, " << nodes.size() << " node)" << endl;
+    for (const auto& [depth, root] : iterations) {
+        cout << "\n--- DEPTH " << depth << " ---" << endl;
+        if (root >= 0) print(print, root, 0);
+    }
+    return 0;
+}
+
+// Cari move legal yang cocok dengan notasi UCI (flag move diambil dari generator)
+Move findLegalMove(const ChessBoard& board, const string& moveStr) {
+    Move parsed = board.parseMove(moveStr);
+    MoveList legalMoves;
+    board.generateLegalMoves(legalMoves);
+    for (const Move& move : legalMoves) {
+        if (move == parsed) return move;
+    }
+    return Move();
+}
+
+// Mode UCI untuk GUI/tournament manager: tanpa output dekoratif, hanya respons protokol,
+// baris info dan bestmove. Search berjalan di thread worker sehingga stop/isready tetap
+// dilayani selama search
+int runUci() {
+    ChessBoard board;
+    ChessEngine engine;
+    engine.setUciOutput(true);
+    
+    string line;
+    while (getline(cin, line)) {
+        istringstream in(line);
+        string command;
+        in >> command;
+        
+        if (command == "uci") {
+            cout << "id name Simple Chess Engine" << endl;
+            cout << "id author Ferdiansyah Pratama" << endl;
+            cout << "option name Hash type spin default 16 min 1 max 16384" << endl;
+            cout << "option name Threads type spin default 1 min 1 max 256" << endl;
+            cout << "option name UseNNUE type check default false" << endl;
+            cout << "option name EvalFile type string default <empty>" << endl;
+            cout << "uciok" << endl;
+        } else if (command == "isready") {
+            cout << "readyok" << endl;
+        } else if (command == "stop") {
+            engine.stopSearch();
+        } else if (command == "quit") {
+            break;
+        } else if (command == "ucinewgame") {
+            engine.waitSearchQuietly();
+            engine.newGame();
+        } else if (command == "setoption") {
+            // setoption name <nama> value <nilai>; nama option boleh berisi spasi
+            engine.waitSearchQuietly();
+            string token, name, value;
+            in >> token;
+            while (in >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+            getline(in >> ws, value);
+            
+            if (name == "Hash") engine.setHashSize(max(1, min(atoi(value.c_str()), 16384)));
+            else if (name == "Threads") engine.setThreadCount(atoi(value.c_str()));
+            else if (name == "UseNNUE") engine.setUseNnue(value == "true");
+            else if (name == "EvalFile" && !nnueNetwork().load(value)) {
+                cout << "info string gagal memuat network " << value << endl;
+            }
+        } else if (command == "position") {
+            engine.waitSearchQuietly();
+            string token, fen;
+            in >> token;
+            if (token == "startpos") {
+                fen = START_FEN;
+                in >> token;
+            } else if (token == "fen") {
+                while (in >> token && token != "moves") fen += (fen.empty() ? "" : " ") + token;
+            }
+            board.setFromFEN(fen);
+            if (token == "moves") {
+                while (in >> token) {
+                    Move move = findLegalMove(board, token);
+                    if (!move.isValid()) break;
+                    board.makeMove(move);
+                    board.trimHistory();
+                }
+            }
+        } else if (command == "go") {
+            engine.waitSearchQuietly();
+            long long time[2] = {0, 0}, increment[2] = {0, 0}, moveTime = 0;
+            int depth = 64, movesToGo = 0;
+            uint64_t nodes = 0;
+            bool infinite = false;
+            
+            string token;
+            while (in >> token) {
+                if (token == "wtime") in >> time[WHITE];
+                else if (token == "btime") in >> time[BLACK];
+                else if (token == "winc") in >> increment[WHITE];
+                else if (token == "binc") in >> increment[BLACK];
+                else if (token == "movestogo") in >> movesToGo;
+                else if (token == "movetime") in >> moveTime;
+                else if (token == "depth") in >> depth;
+                else if (token == "nodes") in >> nodes;
+                else if (token == "infinite") infinite = true;
+            }
+            
+            Color us = board.getCurrentPlayer();
+            engine.setMaxDepth(max(1, min(depth, 64)));
+            if (moveTime > 0) engine.setMoveTime(moveTime);
+            else engine.setTimeLimit(0);
+            engine.setClock(moveTime > 0 ? 0 : time[us], increment[us], movesToGo);
+            engine.setNodeLimit(nodes);
+            engine.setInfinite(infinite);
+            engine.startSearch(board, true);
+        }
+    }
+    
+    engine.stopSearch();
+    engine.waitSearchQuietly();
+    return 0;
+}
+
+// Gabungkan argumen sisa menjadi satu FEN (boleh diberi tanpa tanda kutip)
+string joinArgs(int argc, char* argv[], int first) {
+    string result;
+    for (int i = first; i < argc; i++) {
+        if (!result.empty()) result += " ";
+        result += argv[i];
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    bool nnueLoaded = false;
+    if (argc > 1) {
+        string mode = argv[1];
+        
+        if (mode == "--perft-suite") {
+            return runPerftSuite() ? 0 : 1;
+        }
+        
+        if (mode == "--uci") {
+            return runUci();
+        }
+        
+        if (mode == "--render-trace" && argc > 2) {
+            return renderTrace(argv[2], argc > 3 ? argv[3] : "text");
+        }
+        
+        if (mode == "--smp-scaling" && argc > 2) {
+            runSmpScaling(max(1, atoi(argv[2])), argc > 3 ? max(1, atoi(argv[3])) : 10);
+            return 0;
+        }
+        
+        if (mode == "--bench") {
+            runBench(argc > 2 ? max(1, atoi(argv[2])) : 8, argc > 3 ? max(1, atoi(argv[3])) : 1);
+            return 0;
+        }
+        
+        if ((mode == "--perft" || mode == "--divide") && argc > 2) {
+            string fen = (argc > 3) ? joinArgs(argc, argv, 3) : START_FEN;
+            runPerft(fen, atoi(argv[2]), mode == "--divide");
+            return 0;
+        }
+        
+        // Tulis network bawaan sebagai contoh format file
+        if (mode == "--nnue-export" && argc > 2) {
+            return nnueNetwork().save(argv[2]) ? 0 : 1;
+        }
+        
+        // Network dari file; permainan interaktif dilanjutkan dengan evaluasi NNUE
+        if (mode == "--nnue" && argc > 2) {
+            nnueLoaded = nnueNetwork().load(argv[2]);
+            if (!nnueLoaded) {
+                cout << "❌ Gagal memuat network NNUE dari " << argv[2] << ", memakai evaluasi klasik" << endl;
+            }
+        } else {
+            cout << "Penggunaan: " << argv[0] << " [--uci | --perft <depth> [fen] | --divide <depth> [fen] | --perft-suite"
+                 << " | --smp-scaling <threads> [depth] | --bench [depth] [threads] | --nnue <file> | --nnue-export <file>"
+                 << " | --render-trace <file> [text|dot]]" << endl;
+            return 1;
+        }
+    }
+    
     ChessBoard board;
     ChessEngine engine;
+    engine.setUseNnue(nnueLoaded);
     
     cout << "🏁 Selamat datang di Chess Engine C++ Advanced!" << endl;
     cout << "═══════════════════════════════════════════════" << endl;
@@ -1180,7 +4474,8 @@ int main() {
     // Tampilkan konfigurasi awal
     engine.showConfig();
     
-    while (!board.isGameOver()) {
+    // Repetisi tiga kali atau aturan 50 langkah juga mengakhiri permainan
+    while (!board.isGameOver() && !board.isDrawByRule(2)) {
         board.printBoard();
         
         if (board.isInCheck(board.getCurrentPlayer())) {
@@ -1190,7 +4485,8 @@ int main() {
         string playerName = (board.getCurrentPlayer() == WHITE) ? "Putih (Anda)" : "Hitam (Engine)";
         cout << "Giliran: " << playerName << endl;
         
-        vector<Move> legalMoves = board.generateLegalMoves();
+        MoveList legalMoves;
+        board.generateLegalMoves(legalMoves);
         cout << "Gerakan legal: " << legalMoves.size() << endl;
         
         if (board.getCurrentPlayer() == WHITE) {
@@ -1205,11 +4501,14 @@ int main() {
                 transform(command.begin(), command.end(), command.begin(), ::tolower);
                 
                 if (command == "quit") {
+                    engine.stopPonder();
                     cout << "Terima kasih telah bermain!" << endl;
                     return 0;
                 }
                 
                 if (command == "config") {
+                    // Konfigurasi (hash, thread) tidak boleh berubah saat ponder berjalan
+                    engine.stopPonder();
                     engine.configure();
                     continue;
                 }
@@ -1227,9 +4526,9 @@ int main() {
                 if (command == "help") {
                     cout << "📋 GERAKAN LEGAL YANG TERSEDIA:" << endl;
                     cout << "══════════════════════════════" << endl;
-                    for (size_t i = 0; i < legalMoves.size(); i++) {
+                    for (int i = 0; i < legalMoves.size(); i++) {
                         cout << legalMoves[i].toString();
-                        if (legalMoves[i].isCapture) cout << " (capture)";
+                        if (legalMoves[i].isCapture()) cout << " (capture)";
                         if ((i + 1) % 8 == 0) cout << endl;
                         else cout << "  ";
                     }
@@ -1248,7 +4547,7 @@ int main() {
                 // Check if move is legal
                 bool isLegal = false;
                 for (const Move& legalMove : legalMoves) {
-                    if (legalMove.from == move.from && legalMove.to == move.to) {
+                    if (legalMove == move) {
                         isLegal = true;
                         break;
                     }
@@ -1261,12 +4560,13 @@ int main() {
                     }
                     
                     board.makeMove(move);
+                    board.trimHistory();
                     cout << "✓ Gerakan Anda: " << move.toString() << endl;
                     break;
                 } else {
                     cout << "❌ Gerakan ilegal!" << endl;
                     cout << "Contoh gerakan legal: ";
-                    for (size_t i = 0; i < min(size_t(5), legalMoves.size()); i++) {
+                    for (int i = 0; i < min(5, legalMoves.size()); i++) {
                         cout << legalMoves[i].toString() << " ";
                     }
                     cout << "\nKetik 'help' untuk melihat semua gerakan legal." << endl;
@@ -1277,7 +4577,9 @@ int main() {
             Move bestMove = engine.getBestMove(board);
             if (bestMove.isValid()) {
                 board.makeMove(bestMove);
+                board.trimHistory();
                 cout << "\n🎯 Engine memilih: " << bestMove.toString() << endl;
+                engine.startPonder(board);
                 cout << "Tekan Enter untuk melanjutkan...";
                 cin.get(); // Pause agar user bisa melihat analisis
             } else {
@@ -1288,13 +4590,22 @@ int main() {
     }
     
     // Game over
+    engine.stopPonder();
     board.printBoard();
     
+    cout << "Riwayat gerakan:";
+    for (const string& moveStr : board.getMoveHistory()) {
+        cout << " " << moveStr;
+    }
+    cout << endl;
+    
     if (board.isCheckmate()) {
         Color winner = Color(1 - board.getCurrentPlayer());
         cout << "\n🎉 " << (winner == WHITE ? "Putih" : "Hitam") << " menang!" << endl;
     } else if (board.isStalemate()) {
         cout << "\n🤝 Permainan seri!" << endl;
+    } else if (board.isDrawByRule(2)) {
+        cout << "\n🤝 Permainan seri (repetisi / aturan 50 langkah)!" << endl;
     }
     
     // Tampilkan ringkasan analisis gerakan